@@ -32,8 +32,8 @@ actor_t *actor_spawn(map_t *map, actor_spawn_t *spawn) {
   actor->id = spawn->id;
   actor->type = spawn->type;
   actor->cls = cls;
-  actor->ticker = cls->ticker;
-  actor->drawer = cls->drawer;
+  actor_set_ticker(map, actor, cls->ticker);
+  actor_set_drawer(map, actor, cls->drawer);
   actor->collider = cls->collider;
   actor->sound_channel = -1;
   LIST_INIT(&actor->callers);
@@ -49,10 +49,33 @@ actor_t *actor_spawn(map_t *map, actor_spawn_t *spawn) {
   return actor;
 }
 
+void actor_set_ticker(map_t *map, actor_t *actor, actor_ticker_t ticker) {
+  actor->ticker = ticker;
+  // unlinking happens lazily in map_tick so tickers can clear each other safely
+  if (ticker && !ACTOR_LIST_LINKED(actor, tick_entry))
+    LIST_INSERT_HEAD(&map->tickers, actor, tick_entry);
+}
+
+void actor_set_drawer(map_t *map, actor_t *actor, actor_drawer_t drawer) {
+  actor->drawer = drawer;
+  if (drawer && !ACTOR_LIST_LINKED(actor, draw_entry))
+    LIST_INSERT_HEAD(&map->drawables, actor, draw_entry);
+  else if (!drawer && ACTOR_LIST_LINKED(actor, draw_entry)) {
+    ACTOR_LIST_REMOVE(actor, draw_entry);
+    if (ACTOR_LIST_LINKED(actor, grid_entry))
+      ACTOR_LIST_REMOVE(actor, grid_entry);
+  }
+}
+
 void actor_play_fx(actor_t *actor, uint16_t sound_id, int priority) {
   float x, y;
   world_get_actor_position(actor, &x, &y);
   sound_play_fx(sound_id, x, y, priority, &actor->sound_channel);
+  // the mixer resets the channel when the sound ends, map_tick prunes the list
+  if (actor->sound_channel != -1 && !ACTOR_LIST_LINKED(actor, sound_entry)) {
+    map_t *map = world_body_get_map(actor->body);
+    LIST_INSERT_HEAD(&map->sounding, actor, sound_entry);
+  }
 }
 
 void actor_destroy(map_t *map, actor_t *actor) {
@@ -62,8 +85,8 @@ void actor_destroy(map_t *map, actor_t *actor) {
   if (actor->flags & AF_COLLISION_OWNED)
     free(actor->collision);
   sound_release_channel(&actor->sound_channel);
-  actor->ticker = NULL;
-  actor->drawer = NULL;
+  actor_set_ticker(map, actor, NULL);
+  actor_set_drawer(map, actor, NULL);
   actor->collider = NULL;
   LIST_REMOVE(actor, map);
   LIST_INSERT_HEAD(&map->dead, actor, map);
@@ -89,6 +112,12 @@ void actor_finalize(actor_t *actor) {
     actor->cls->cleanup(actor);
   if (actor->body)
     world_body_destroy(actor->body);
+  if (ACTOR_LIST_LINKED(actor, tick_entry))
+    LIST_REMOVE(actor, tick_entry);
+  if (ACTOR_LIST_LINKED(actor, draw_entry))
+    LIST_REMOVE(actor, draw_entry);
+  if (ACTOR_LIST_LINKED(actor, sound_entry))
+    LIST_REMOVE(actor, sound_entry);
   LIST_REMOVE(actor, map);
   free(actor);
 }
@@ -184,7 +213,9 @@ void actor_sprite_init(map_t *map, actor_t *actor, actor_spawn_t *spawn) {
 static void actor_sprite_tick(map_t *map, actor_t *actor) {
   actor_sprite_t *sprite = (actor_sprite_t *) actor;
   collision_t *old_collision = actor->collision;
-  if (sprite_anim_tick(&sprite->anim) || old_collision != actor->collision)
+  if (sprite_anim_tick(&sprite->anim) && !(actor->flags & AF_COLLISION_OWNED))
+    actor->collision = tiles_get_collision(sprite->anim.tiles, sprite->anim.frame);
+  if (old_collision != actor->collision)
     world_update_actor_collision(actor);
 }
 
@@ -231,10 +262,39 @@ void actor_model_cleanup(actor_t *actor) {
     model_pool_unload(model->list);
 }
 
+// particles and parts the class loads after spawning
+static const asset_ref_t player_assets[] = {
+  { AK_GFX, GFX_BUBBLE }, { AK_TILESET, TILESET_BUBBLE }, { AK_NONE },
+};
+
+static const asset_ref_t mine_sm_assets[] = {
+  { AK_GFX, GFX_WATER_EXPL_SM }, { AK_TILESET, TILESET_WATER_EXPL_SM },
+  { AK_GFX, GFX_BUBBLES }, { AK_TILESET, TILESET_BUBBLES }, { AK_NONE },
+};
+
+static const asset_ref_t mine_med_assets[] = {
+  { AK_GFX, GFX_WATER_EXPL_MID }, { AK_TILESET, TILESET_WATER_EXPL_MID },
+  { AK_GFX, GFX_BUBBLES }, { AK_TILESET, TILESET_BUBBLES }, { AK_NONE },
+};
+
+static const asset_ref_t mine_big_assets[] = {
+  { AK_GFX, GFX_WATER_EXPL_BIG }, { AK_TILESET, TILESET_WATER_EXPL_BIG },
+  { AK_GFX, GFX_BUBBLES }, { AK_TILESET, TILESET_BUBBLES }, { AK_NONE },
+};
+
+static const asset_ref_t spaceship_assets[] = {
+  { AK_MODEL, MODEL_SPACESHIP }, { AK_GFX, GFX_THRUST }, { AK_TILESET, TILESET_THRUST }, { AK_NONE },
+};
+
+static const asset_ref_t submarine_assets[] = {
+  { AK_MODEL, MODEL_SUB }, { AK_GFX, GFX_PROPELLER }, { AK_NONE },
+};
+
 actor_class_t actor_classes[] = {
   [AT_TRIGGER] = {
     .init = trigger_init,
     .collider = trigger_collide,
+    .contact_events = CE_BEGIN,
     .cleanup = trigger_cleanup,
     .struct_size = sizeof(trigger_t),
     .flags = AF_STATIC,
@@ -245,9 +305,11 @@ actor_class_t actor_classes[] = {
   [AT_YELLOW] = {
     .gfx_id = GFX_YELLOW,
     .tiles_id = TILESET_YELLOW,
+    .assets = player_assets,
     .init = player_init,
     .ticker = player_tick,
     .collider = player_collide,
+    .contact_events = CE_BEGIN | CE_END,
     .damage = player_damage,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
@@ -261,9 +323,11 @@ actor_class_t actor_classes[] = {
   [AT_PINK] = {
     .gfx_id = GFX_PINK,
     .tiles_id = TILESET_PINK,
+    .assets = player_assets,
     .init = player_init,
     .ticker = player_tick,
     .collider = player_collide,
+    .contact_events = CE_BEGIN | CE_END,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(player_t),
@@ -276,9 +340,11 @@ actor_class_t actor_classes[] = {
   [AT_BLUE] = {
     .gfx_id = GFX_BLUE,
     .tiles_id = TILESET_BLUE,
+    .assets = player_assets,
     .init = player_init,
     .ticker = player_tick,
     .collider = player_collide,
+    .contact_events = CE_BEGIN | CE_END,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(player_t),
@@ -320,6 +386,7 @@ actor_class_t actor_classes[] = {
     .init = actor_sprite_init,
     .ticker = mushroom_tick,
     .collider = mushroom_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -334,6 +401,7 @@ actor_class_t actor_classes[] = {
     .init = actor_sprite_init,
     .ticker = mushroom_tick,
     .collider = mushroom_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -465,9 +533,11 @@ actor_class_t actor_classes[] = {
   [AT_MINE_SM] = {
     .gfx_id = GFX_MINE_SM,
     .tiles_id = TILESET_MINE_SM,
+    .assets = mine_sm_assets,
     .init = mine_init,
     .ticker = mine_tick,
     .collider = mine_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -481,9 +551,11 @@ actor_class_t actor_classes[] = {
   [AT_MINE_MED] = {
     .gfx_id = GFX_MINE_MED,
     .tiles_id = TILESET_MINE_MED,
+    .assets = mine_med_assets,
     .init = mine_init,
     .ticker = mine_tick,
     .collider = mine_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -497,9 +569,11 @@ actor_class_t actor_classes[] = {
   [AT_MINE_BIG] = {
     .gfx_id = GFX_MINE_BIG,
     .tiles_id = TILESET_MINE_BIG,
+    .assets = mine_big_assets,
     .init = mine_init,
     .ticker = mine_tick,
     .collider = mine_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -516,6 +590,7 @@ actor_class_t actor_classes[] = {
     .init = crystal_init,
     .ticker = crystal_tick,
     .collider = crystal_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(crystal_t),
@@ -531,6 +606,7 @@ actor_class_t actor_classes[] = {
     .init = crystal_init,
     .ticker = crystal_tick,
     .collider = crystal_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(crystal_t),
@@ -546,6 +622,7 @@ actor_class_t actor_classes[] = {
     .init = actor_sprite_init,
     .ticker = actor_sprite_tick,
     .collider = powerup_collide,
+    .contact_events = CE_BEGIN,
     .drawer = render_sprite,
     .cleanup = actor_sprite_cleanup,
     .struct_size = sizeof(actor_sprite_t),
@@ -623,6 +700,7 @@ actor_class_t actor_classes[] = {
   [AT_SPACESHIP] = {
     .gfx_id = GFX_SPACESHIP,
     .tiles_id = TILESET_SPACESHIP,
+    .assets = spaceship_assets,
     .init = spaceship_init,
     .ticker = spaceship_tick,
     .drawer = render_spaceship,
@@ -635,6 +713,7 @@ actor_class_t actor_classes[] = {
   [AT_SUBMARINE] = {
     .gfx_id = GFX_SUB,
     .tiles_id = TILESET_SUB,
+    .assets = submarine_assets,
     .init = submarine_init,
     .ticker = submarine_tick,
     .drawer = render_submarine,
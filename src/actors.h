@@ -28,6 +28,13 @@ typedef enum {
   DS_PHYSICAL,
 } damage_source_t;
 
+// contact events a class's collider is called for, old is only set for presolve
+typedef enum {
+  CE_BEGIN    = 1 << 0,
+  CE_END      = 1 << 1,
+  CE_PRESOLVE = 1 << 2,
+} contact_events_t;
+
 typedef void (*actor_init_t)(map_t *map, actor_t *, actor_spawn_t *);
 typedef void (*actor_ticker_t)(map_t *, actor_t *);
 typedef void (*actor_set_target_t)(map_t *, actor_t *, actor_target_t);
@@ -46,17 +53,23 @@ typedef struct {
   actor_cleanup_t cleanup;
   uint16_t gfx_id;
   uint16_t tiles_id;
+  const asset_ref_t *assets; // loaded besides gfx_id and tiles_id, ends at AK_NONE
   uint32_t flags;
   size_t struct_size;
   int16_t draw_priority;
   int16_t collide_priority;
   uint16_t category_bits;
   uint16_t category_mask;
+  uint8_t contact_events;
   float density;
 } actor_class_t;
 
 struct actor_s {
   LIST_ENTRY(actor_s) map;
+  LIST_ENTRY(actor_s) tick_entry;
+  LIST_ENTRY(actor_s) draw_entry;
+  LIST_ENTRY(actor_s) grid_entry;
+  LIST_ENTRY(actor_s) sound_entry;
   LIST_HEAD(, script_state_s) callers;
   actor_ticker_t ticker;
   actor_drawer_t drawer;
@@ -67,7 +80,8 @@ struct actor_s {
   const actor_class_t *cls;
   collision_t *collision;
   body_t *body;
-  uint32_t frame_drawn;
+  irect2_t bounds;
+  uint32_t grid_cell;
   int sound_channel;
 };
 
@@ -107,6 +121,13 @@ typedef enum {
   AF_DESTROYED       = 1 << 31,
 } actor_flags_t;
 
+// sublist entries are cleared on removal so membership can be tested
+#define ACTOR_LIST_LINKED(actor, field) ((actor)->field.le_prev != NULL)
+#define ACTOR_LIST_REMOVE(actor, field) do { \
+    LIST_REMOVE((actor), field); \
+    (actor)->field.le_prev = NULL; \
+  } while (0)
+
 extern actor_class_t actor_classes[NUM_ACTORS];
 extern const size_t actor_class_count;
 
@@ -133,6 +154,8 @@ typedef struct {
 } actor_model_t;
 
 actor_t *actor_spawn(map_t *map, actor_spawn_t *spawn);
+void actor_set_ticker(map_t *map, actor_t *actor, actor_ticker_t ticker);
+void actor_set_drawer(map_t *map, actor_t *actor, actor_drawer_t drawer);
 void actor_play_fx(actor_t *actor, uint16_t sound_id, int priority);
 void actor_destroy(map_t *map, actor_t *actor);
 void actor_finalize(actor_t *actor);
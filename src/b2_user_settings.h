@@ -16,10 +16,10 @@ enum body_type_t {
   BODY_UNKNOWN,
   BODY_ACTOR,
   BODY_GROUND,
-  BODY_WATER,
 };
 
 typedef struct actor_s actor_t;
+typedef struct collision_s collision_t;
 
 /// You can define this to inject whatever data you want in b2Body
 struct B2_API b2BodyUserData
@@ -41,8 +41,15 @@ struct B2_API b2FixtureUserData
 	b2FixtureUserData()
 	{
 		id = 0;
+    flags = 0;
+    active = true;
+    group = nullptr;
 	}
   uint32_t id;
+  uint16_t flags;
+  // actor fixtures are cached per collision stream, only one group is active
+  bool active;
+  const collision_t *group;
 };
 
 /// You can define this to inject whatever data you want in b2Joint
@@ -59,16 +66,20 @@ struct B2_API b2JointUserData
 B2_API void* b2Alloc_Default(int32 size);
 B2_API void b2Free_Default(void* mem);
 
+/// Size class and block allocator chunk pools in the live world's arena, see world.cpp
+B2_API void* world_b2_alloc(int32 size);
+B2_API void world_b2_free(void* mem);
+
 /// Implement this function to use your own memory allocator.
 inline void* b2Alloc(int32 size)
 {
-	return b2Alloc_Default(size);
+	return world_b2_alloc(size);
 }
 
 /// If you implement b2Alloc, you should also implement this function.
 inline void b2Free(void* mem)
 {
-	b2Free_Default(mem);
+	world_b2_free(mem);
 }
 
 /// Implement this to use your own logging.
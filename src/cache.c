@@ -2,78 +2,285 @@
 #include <inttypes.h>
 #include <string.h>
 #include <model64.h>
-#include <sys/queue.h>
 #include <stdlib.h>
+#include <sys/queue.h>
 #include <GL/gl.h>
 #include <debug.h>
+#include <dfs.h>
+#include <n64sys.h>
 
 #include "cache.h"
+#include "assets.h"
 #include "sprite.h"
 #include "actors.h"
 
 #define TILES_MAGIC 0x54494c45 // TILE
+#define CACHE_MODEL_LIST_SIZE 8192 // rough size of one compiled mesh
+#define CACHE_QUEUE_SIZE 32 // power of two
+#define CACHE_PENDING_FRAMES 60 // queued loads nobody came back for are released
 
+// every pool is a table indexed by asset id, plus a reverse table from the
+// loaded data to its id for the unload calls. the reverse table is open
+// addressed, holds ids and is kept at most half full.
+// files nobody holds stay loaded on an lru list shared by all pools until
+// the resident total goes over the budget. pinned files skip the lru and
+// stay loaded, CACHE_PIN_GL pins everything that owns gl objects so models
+// and textures survive map changes without being rebuilt. cache_warm unpins
+// whatever the next map doesn't list
+typedef struct cache_pool_s cache_pool_t;
 typedef struct cached_file_s cached_file_t;
-typedef SLIST_HEAD(cache_pool_s, cached_file_s) cache_pool_t;
-
-cached_file_t *cached_file_open(cache_pool_t *pool, uint16_t id, const char * const * const paths, uintptr_t (*load_func)(const char *, uintptr_t arg), uintptr_t arg);
-void cached_file_close(cache_pool_t *pool, uintptr_t ptr, void (*unload_func)(uintptr_t , uintptr_t arg));
 
 struct cached_file_s {
   uintptr_t data;
-  uint32_t refcount;
   uintptr_t arg;
-  SLIST_ENTRY(cached_file_s) pool;
-  uint16_t id;
+  uint32_t refcount;
+  uint32_t size;
+  uint32_t pending_frame;
+  bool queued;
+  bool pending; // loaded from the queue, holds a ref for whoever asked
+  bool pinned;
+  bool listed; // scratch for cache_warm
+  cache_pool_t *pool;
+  TAILQ_ENTRY(cached_file_s) lru; // or the pending list
 };
 
-cached_file_t *cached_file_open(cache_pool_t *pool, uint16_t id, const char * const * const paths, uintptr_t (*load_func)(const char *, uintptr_t arg), uintptr_t arg) {
-  cached_file_t *link;
-  SLIST_FOREACH(link, pool, pool) {
-    if (id == link->id) {
-      link->refcount++;
-      return link;
-    }
+struct cache_pool_s {
+  cached_file_t *files;
+  uint16_t *reverse; // 0 is an empty slot, id 0 is never loaded
+  uint16_t count;
+  uint8_t reverse_bits;
+  uint8_t kind;
+  uint32_t hits;
+  uint32_t misses;
+  uint64_t load_ticks;
+  const char * const *paths;
+  uintptr_t (*load_func)(const char *, uintptr_t *arg, uint32_t *size);
+  void (*unload_func)(uintptr_t, uintptr_t arg);
+};
+
+#define CACHE_POOL(name, kind_, num, paths_, load, unload) \
+  static cached_file_t name##_files[num]; \
+  static cache_pool_t name = { \
+    .files = name##_files, .count = num, .kind = kind_, .paths = paths_, .load_func = load, .unload_func = unload, \
   }
 
-  uintptr_t data = load_func(paths[id], arg);
-  link = malloc(sizeof(cached_file_t));
-  assertf(link != NULL, "out of memory");
-  link->refcount = 1;
-  link->data = data;
-  link->arg = arg;
-  link->id = id;
-  SLIST_INSERT_HEAD(pool, link, pool);
-  return link;
+typedef struct {
+  cache_pool_t *pool;
+  uint16_t id;
+} cache_request_t;
+
+static TAILQ_HEAD(, cached_file_s) cache_lru = TAILQ_HEAD_INITIALIZER(cache_lru);
+static TAILQ_HEAD(, cached_file_s) cache_pending = TAILQ_HEAD_INITIALIZER(cache_pending);
+static uint32_t cache_queue_frame;
+static cache_stats_t cache_stats;
+static cache_request_t cache_queue[CACHE_QUEUE_SIZE];
+static uint32_t cache_queue_head, cache_queue_tail;
+
+cached_file_t *cached_file_open(cache_pool_t *pool, uint16_t id, uintptr_t arg);
+void cached_file_close(cache_pool_t *pool, uintptr_t ptr);
+
+static inline uint32_t cache_reverse_slot(cache_pool_t *pool, uintptr_t data) {
+  return ((uint32_t) data * 0x9e3779b1u) >> (32 - pool->reverse_bits);
 }
 
-void cached_file_close(cache_pool_t *pool, uintptr_t ptr, void (*unload_func)(uintptr_t , uintptr_t arg)) {
-  cached_file_t *link, *prev = NULL;
-  SLIST_FOREACH(link, pool, pool) {
-    if (link->data == ptr) {
-      link->refcount--;
-      if (link->refcount == 0) {
+static void cache_reverse_insert(cache_pool_t *pool, uint16_t id) {
+  if (!pool->reverse) {
+    pool->reverse_bits = 2;
+    while ((1u << pool->reverse_bits) < pool->count * 2u)
+      pool->reverse_bits++;
+    pool->reverse = calloc(1 << pool->reverse_bits, sizeof(uint16_t));
+    assertf(pool->reverse != NULL, "out of memory");
+  }
+  uint32_t mask = (1 << pool->reverse_bits) - 1;
+  uint32_t slot = cache_reverse_slot(pool, pool->files[id].data);
+  while (pool->reverse[slot])
+    slot = (slot + 1) & mask;
+  pool->reverse[slot] = id;
+}
 
-        if (SLIST_FIRST(pool) == link)
-          pool->slh_first = link->pool.sle_next;
-        else
-          prev->pool.sle_next = link->pool.sle_next;
+static int32_t cache_reverse_find(cache_pool_t *pool, uintptr_t data) {
+  if (!pool->reverse)
+    return -1;
+  uint32_t mask = (1 << pool->reverse_bits) - 1;
+  uint32_t slot = cache_reverse_slot(pool, data);
+  uint16_t id;
+  while ((id = pool->reverse[slot])) {
+    if (pool->files[id].data == data)
+      return slot;
+    slot = (slot + 1) & mask;
+  }
+  return -1;
+}
 
-        unload_func(ptr, link->arg);
-        free(link);
-      }
-      return;
+// shifts the rest of the run back so lookups never stop at a hole
+static void cache_reverse_delete(cache_pool_t *pool, uint32_t hole) {
+  uint32_t mask = (1 << pool->reverse_bits) - 1;
+  uint32_t slot = hole;
+  while (true) {
+    slot = (slot + 1) & mask;
+    uint16_t next = pool->reverse[slot];
+    if (!next)
+      break;
+    uint32_t home = cache_reverse_slot(pool, pool->files[next].data);
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      pool->reverse[hole] = next;
+      hole = slot;
     }
-    prev = link;
   }
-  assertf(0, "value 0x%"PRIuPTR" already removed from pool", ptr);
+  pool->reverse[hole] = 0;
+}
+
+static void cache_evict(cached_file_t *file) {
+  cache_pool_t *pool = file->pool;
+  TAILQ_REMOVE(&cache_lru, file, lru);
+  cache_reverse_delete(pool, cache_reverse_find(pool, file->data));
+  pool->unload_func(file->data, file->arg);
+  cache_stats.resident_bytes -= file->size;
+  cache_stats.retained_bytes -= file->size;
+  cache_stats.retained_count--;
+  cache_stats.evictions++;
+  memset(file, 0, sizeof(cached_file_t));
+}
+
+static void cache_trim(void) {
+  if (!cache_stats.budget)
+    cache_stats.budget = get_memory_size() > 0x400000 ? CACHE_BUDGET_8MB : CACHE_BUDGET_4MB;
+  cached_file_t *file;
+  while (cache_stats.resident_bytes > cache_stats.budget && (file = TAILQ_FIRST(&cache_lru)))
+    cache_evict(file);
+}
+
+cached_file_t *cached_file_open(cache_pool_t *pool, uint16_t id, uintptr_t arg) {
+  assertf(id > 0 && id < pool->count, "invalid asset id %"PRIu16, id);
+  cached_file_t *file = &pool->files[id];
+  if (file->data) {
+    // pinned files never go on the lru
+    if (!file->refcount++ && !file->pinned) {
+      TAILQ_REMOVE(&cache_lru, file, lru);
+      cache_stats.retained_bytes -= file->size;
+      cache_stats.retained_count--;
+    }
+    cache_stats.hits++;
+    pool->hits++;
+    return file;
+  }
+
+  cache_stats.misses++;
+  pool->misses++;
+  uint32_t size = 0;
+  uint32_t start = get_ticks();
+  file->arg = arg;
+  file->data = pool->load_func(pool->paths[id], &file->arg, &size);
+  pool->load_ticks += get_ticks() - start;
+  file->refcount = 1;
+  file->size = size;
+  file->pool = pool;
+  cache_reverse_insert(pool, id);
+  cache_stats.resident_bytes += size;
+  cache_trim();
+  return file;
+}
+
+// hands out the file if it's resident, otherwise queues it for
+// cache_service_queue and returns NULL. a full queue drops the request, the
+// caller asks again next frame
+static cached_file_t *cached_file_try_open(cache_pool_t *pool, uint16_t id) {
+  assertf(id > 0 && id < pool->count, "invalid asset id %"PRIu16, id);
+  cached_file_t *file = &pool->files[id];
+  if (file->pending) {
+    // take over the queue's ref, so the file can't be trimmed before this
+    TAILQ_REMOVE(&cache_pending, file, lru);
+    file->pending = false;
+    cache_stats.hits++;
+    pool->hits++;
+    return file;
+  }
+  if (file->data)
+    return cached_file_open(pool, id, 0);
+  if (!file->queued && cache_queue_tail - cache_queue_head < CACHE_QUEUE_SIZE) {
+    file->queued = true;
+    cache_queue[cache_queue_tail++ & (CACHE_QUEUE_SIZE - 1)] = (cache_request_t) { pool, id };
+  }
+  return NULL;
+}
+
+void cached_file_close(cache_pool_t *pool, uintptr_t ptr) {
+  int32_t slot = cache_reverse_find(pool, ptr);
+  cached_file_t *file = slot >= 0 ? &pool->files[pool->reverse[slot]] : NULL;
+  assertf(file && file->refcount, "value 0x%"PRIuPTR" already removed from pool", ptr);
+  if (--file->refcount || file->pinned)
+    return;
+  TAILQ_INSERT_TAIL(&cache_lru, file, lru);
+  cache_stats.retained_bytes += file->size;
+  cache_stats.retained_count++;
+  cache_trim();
+}
+
+static void cached_file_pin_gl(cached_file_t *file) {
+#ifdef CACHE_PIN_GL
+  file->pinned = true;
+#endif
+}
+
+static void cached_file_set_pinned(cached_file_t *file, bool pinned) {
+  if (file->pinned == pinned)
+    return;
+  file->pinned = pinned;
+  if (!file->data || file->refcount)
+    return;
+  if (pinned) {
+    TAILQ_REMOVE(&cache_lru, file, lru);
+    cache_stats.retained_bytes -= file->size;
+    cache_stats.retained_count--;
+  } else {
+    TAILQ_INSERT_TAIL(&cache_lru, file, lru);
+    cache_stats.retained_bytes += file->size;
+    cache_stats.retained_count++;
+    cache_trim();
+  }
+}
+
+// 0 goes back to the default for the installed ram
+void cache_set_budget(uint32_t bytes) {
+  cache_stats.budget = bytes;
+  cache_trim();
+}
+
+void cache_get_stats(cache_stats_t *stats) {
+  *stats = cache_stats;
 }
 
-static cache_pool_t sprite_pool;
-extern const char * const gfx_paths[];
+// files are read whole and synchronously, the ticks are only checked before
+// each load so one big file can run over budget_ticks. queued files stay held
+// until whoever asked for them comes back, or CACHE_PENDING_FRAMES pass
+void cache_service_queue(uint32_t budget_ticks) {
+  uint32_t start = get_ticks();
+  cache_queue_frame++;
+  cached_file_t *file, *next;
+  TAILQ_FOREACH_SAFE(file, &cache_pending, lru, next) {
+    if (cache_queue_frame - file->pending_frame < CACHE_PENDING_FRAMES)
+      break;
+    TAILQ_REMOVE(&cache_pending, file, lru);
+    file->pending = false;
+    cached_file_close(file->pool, file->data);
+  }
+  while (cache_queue_head != cache_queue_tail && get_ticks() - start < budget_ticks) {
+    cache_request_t *request = &cache_queue[cache_queue_head++ & (CACHE_QUEUE_SIZE - 1)];
+    file = &request->pool->files[request->id];
+    file->queued = false;
+    if (file->data)
+      continue;
+    file = cached_file_open(request->pool, request->id, 0);
+    file->pending = true;
+    file->pending_frame = cache_queue_frame;
+    TAILQ_INSERT_TAIL(&cache_pending, file, lru);
+  }
+}
 
-static uintptr_t cache_sprite(const char *filename, uintptr_t arg) {
-  return (uintptr_t) sprite_load(filename);
+static uintptr_t cache_sprite(const char *filename, uintptr_t *arg, uint32_t *size) {
+  sprite_t *sprite = sprite_load(filename);
+  *size = sizeof(sprite_t) + TEX_FORMAT_PIX2BYTES(sprite_get_format(sprite), sprite->width * sprite->height);
+  return (uintptr_t) sprite;
 }
 
 static void uncache_sprite(uintptr_t sprite, uintptr_t arg) {
@@ -84,12 +291,14 @@ static void uncache_sprite(uintptr_t sprite, uintptr_t arg) {
   sprite_free((void *) sprite);
 }
 
+CACHE_POOL(sprite_pool, AK_GFX, NUM_GFX, gfx_paths, cache_sprite, uncache_sprite);
+
 sprite_t *sprite_pool_load(int id) {
-  return (sprite_t *) cached_file_open(&sprite_pool, id, gfx_paths, cache_sprite, 0)->data;
+  return (sprite_t *) cached_file_open(&sprite_pool, id, 0)->data;
 }
 
 sprite_t *sprite_pool_load_gl(int id, GLuint *tex) {
-  cached_file_t *link = cached_file_open(&sprite_pool, id, gfx_paths, cache_sprite, 0);
+  cached_file_t *link = cached_file_open(&sprite_pool, id, 0);
   if (!link->arg) {
     GLuint tex;
     glGenTextures(1, &tex);
@@ -99,22 +308,27 @@ sprite_t *sprite_pool_load_gl(int id, GLuint *tex) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     link->arg = tex;
   }
+  cached_file_pin_gl(link);
   *tex = link->arg;
   return (sprite_t *) link->data;
 }
 
-void sprite_pool_unload(sprite_t *sprite) {
-  cached_file_close(&sprite_pool, (uintptr_t) sprite, uncache_sprite);
+sprite_t *sprite_pool_try_load(int id) {
+  cached_file_t *file = cached_file_try_open(&sprite_pool, id);
+  return file ? (sprite_t *) file->data : NULL;
 }
 
-static cache_pool_t model_pool;
-extern const char * const model_paths[];
+void sprite_pool_unload(sprite_t *sprite) {
+  cached_file_close(&sprite_pool, (uintptr_t) sprite);
+}
 
-static uintptr_t cache_model(const char *filename, uintptr_t arg) {
+// warming passes 0 for the list count and takes it from the model
+static uintptr_t cache_model(const char *filename, uintptr_t *arg, uint32_t *size) {
   model64_t *model = model64_load(filename);
   uint32_t meshes = model64_get_mesh_count(model);
-  size_t bufsize = (size_t) arg;
-  assertf(bufsize == meshes, "expected space for %"PRIu32" display lists, got %zu", meshes, bufsize);
+  size_t bufsize = (size_t) *arg;
+  assertf(!bufsize || bufsize == meshes, "expected space for %"PRIu32" display lists, got %zu", meshes, bufsize);
+  *arg = meshes;
   GLuint list = glGenLists(meshes);
   for (uint32_t i = 0; i < meshes; i++) {
     glNewList(list+i, GL_COMPILE);
@@ -122,6 +336,7 @@ static uintptr_t cache_model(const char *filename, uintptr_t arg) {
     glEndList();
   }
   model64_free(model);
+  *size = meshes * CACHE_MODEL_LIST_SIZE;
   return list;
 }
 
@@ -129,20 +344,24 @@ static void uncache_model(uintptr_t list, uintptr_t arg) {
   glDeleteLists((GLuint) list, (GLsizei) arg);
 }
 
+CACHE_POOL(model_pool, AK_MODEL, NUM_MODEL, model_paths, cache_model, uncache_model);
+
 GLuint model_pool_load(int id, size_t bufsize) {
-  return cached_file_open(&model_pool, id, model_paths, cache_model, bufsize)->data;
+  cached_file_t *file = cached_file_open(&model_pool, id, bufsize);
+  assertf(file->arg == bufsize, "expected space for %"PRIuPTR" display lists, got %zu", file->arg, bufsize);
+  cached_file_pin_gl(file);
+  return file->data;
 }
 
 void model_pool_unload(GLuint start_list) {
-  cached_file_close(&model_pool, start_list, uncache_model);
+  cached_file_close(&model_pool, start_list);
 }
 
-static cache_pool_t tileset_pool;
-extern const char * const tileset_paths[];
-
-static uintptr_t cache_tileset(const char *filename, uintptr_t arg) {
-  tiles_desc_t *tileset = asset_load(filename, NULL);
+static uintptr_t cache_tileset(const char *filename, uintptr_t *arg, uint32_t *size) {
+  int sz;
+  tiles_desc_t *tileset = asset_load(filename, &sz);
   assertf(tileset->magic == TILES_MAGIC, "%s not a valid tileset", filename);
+  *size = sz;
   return (uintptr_t) tileset;
 }
 
@@ -150,10 +369,150 @@ static void uncache_tileset(uintptr_t tileset, uintptr_t arg) {
   free((tiles_desc_t *) tileset);
 }
 
+CACHE_POOL(tileset_pool, AK_TILESET, NUM_TILESET, tileset_paths, cache_tileset, uncache_tileset);
+
 tiles_desc_t *tileset_pool_load(int id) {
-  return (tiles_desc_t *) cached_file_open(&tileset_pool, id, tileset_paths, cache_tileset, 0)->data;
+  return (tiles_desc_t *) cached_file_open(&tileset_pool, id, 0)->data;
+}
+
+tiles_desc_t *tileset_pool_try_load(int id) {
+  cached_file_t *file = cached_file_try_open(&tileset_pool, id);
+  return file ? (tiles_desc_t *) file->data : NULL;
 }
 
 void tileset_pool_unload(tiles_desc_t *tiles) {
-  cached_file_close(&tileset_pool, (uintptr_t) tiles, uncache_tileset);
+  cached_file_close(&tileset_pool, (uintptr_t) tiles);
+}
+
+static cache_pool_t *cache_kind_pool(uint8_t kind) {
+  switch (kind) {
+  case AK_GFX: return &sprite_pool;
+  case AK_TILESET: return &tileset_pool;
+  case AK_MODEL: return &model_pool;
+  default: return NULL; // sfx are all opened by sound_init
+  }
+}
+
+static const uint8_t cache_pool_kinds[] = { AK_GFX, AK_TILESET, AK_MODEL };
+
+typedef struct {
+  uint32_t rom_addr;
+  cache_pool_t *pool;
+  uint16_t id;
+} cache_warm_t;
+
+static int cache_warm_compare(const void *a, const void *b) {
+  uint32_t addr_a = ((const cache_warm_t *) a)->rom_addr;
+  uint32_t addr_b = ((const cache_warm_t *) b)->rom_addr;
+  return addr_a < addr_b ? -1 : addr_a > addr_b;
+}
+
+// pins only carry over to a map that lists the file again
+static void cache_unpin_unlisted(asset_ref_t *assets, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    cache_pool_t *pool = cache_kind_pool(assets[i].kind);
+    if (pool && assets[i].id && assets[i].id < pool->count)
+      pool->files[assets[i].id].listed = true;
+  }
+  for (size_t k = 0; k < COUNT_OF(cache_pool_kinds); k++) {
+    cache_pool_t *pool = cache_kind_pool(cache_pool_kinds[k]);
+    for (size_t id = 1; id < pool->count; id++) {
+      cached_file_t *file = &pool->files[id];
+      if (file->listed)
+        file->listed = false;
+      else
+        cached_file_set_pinned(file, false);
+    }
+  }
+}
+
+void cache_warm(asset_ref_t *assets, size_t count) {
+  cache_unpin_unlisted(assets, count);
+  cache_warm_t *warm = malloc(count * sizeof(cache_warm_t));
+  assertf(!count || warm != NULL, "out of memory");
+  size_t warm_count = 0;
+  for (size_t i = 0; i < count; i++) {
+    cache_pool_t *pool = cache_kind_pool(assets[i].kind);
+    if (!pool || !assets[i].id || assets[i].id >= pool->count)
+      continue;
+    cached_file_t *file = &pool->files[assets[i].id];
+    if (file->data) {
+      // the last map left it retained, move it behind what only that map used
+      if (!file->refcount && !file->pinned) {
+        TAILQ_REMOVE(&cache_lru, file, lru);
+        TAILQ_INSERT_TAIL(&cache_lru, file, lru);
+      }
+      continue;
+    }
+    const char *path = pool->paths[assets[i].id];
+    if (!strncmp(path, "rom:", 4))
+      path += 4;
+    warm[warm_count++] = (cache_warm_t) { dfs_rom_addr(path), pool, assets[i].id };
+  }
+  // reading front to back keeps the pi from seeking around the rom
+  qsort(warm, warm_count, sizeof(cache_warm_t), cache_warm_compare);
+
+  // stop before the files warmed here start evicting each other, whatever
+  // the last map left retained goes first
+  cache_trim();
+  uint32_t held = cache_stats.resident_bytes - cache_stats.retained_bytes;
+  uint32_t warmed = 0;
+  size_t i;
+  for (i = 0; i < warm_count && held + warmed < cache_stats.budget; i++) {
+    cached_file_t *file = &warm[i].pool->files[warm[i].id];
+    if (file->data)
+      continue; // listed twice
+    file = cached_file_open(warm[i].pool, warm[i].id, 0);
+    cache_stats.misses--; // not asked for yet
+    warm[i].pool->misses--;
+    warmed += file->size;
+    cached_file_close(warm[i].pool, file->data);
+  }
+  if (i < warm_count)
+    debugf("cache: warmed %zu of %zu files, budget full\n", i, warm_count);
+  free(warm);
+}
+
+void cache_get_pool_stats(asset_kind_t kind, cache_pool_stats_t *stats) {
+  memset(stats, 0, sizeof(cache_pool_stats_t));
+  cache_pool_t *pool = cache_kind_pool(kind);
+  if (!pool)
+    return;
+  stats->hits = pool->hits;
+  stats->misses = pool->misses;
+  stats->load_ticks = pool->load_ticks;
+  for (size_t id = 1; id < pool->count; id++) {
+    cached_file_t *file = &pool->files[id];
+    if (!file->data)
+      continue;
+    stats->entries++;
+    stats->bytes += file->size;
+    stats->refs += file->refcount;
+  }
+}
+
+size_t cache_list_resident(cache_entry_info_t *entries, size_t max) {
+  size_t count = 0;
+  for (size_t k = 0; k < COUNT_OF(cache_pool_kinds); k++) {
+    cache_pool_t *pool = cache_kind_pool(cache_pool_kinds[k]);
+    for (size_t id = 1; id < pool->count && count < max; id++) {
+      cached_file_t *file = &pool->files[id];
+      if (file->data)
+        entries[count++] = (cache_entry_info_t) { pool->kind, file->pinned, id, file->size, file->refcount };
+    }
+  }
+  return count;
+}
+
+const char *cache_asset_path(asset_kind_t kind, uint16_t id) {
+  cache_pool_t *pool = cache_kind_pool(kind);
+  if (!pool || !id || id >= pool->count)
+    return NULL;
+  return pool->paths[id];
+}
+
+void cache_set_pinned(asset_kind_t kind, uint16_t id, bool pinned) {
+  cache_pool_t *pool = cache_kind_pool(kind);
+  assertf(pool && id > 0 && id < pool->count, "invalid asset id %"PRIu16, id);
+  cached_file_set_pinned(&pool->files[id], pinned);
 }
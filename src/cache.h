@@ -3,6 +3,9 @@
 #include <GL/gl.h>
 #include <graphics.h>
 #include <model64.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,14 +13,88 @@ extern "C" {
 
 typedef struct tiles_desc_s tiles_desc_t;
 
+// resident bytes (held and retained) the cache may keep, with and without
+// the expansion pak
+#ifndef CACHE_BUDGET_4MB
+#define CACHE_BUDGET_4MB (768 * 1024)
+#endif
+#ifndef CACHE_BUDGET_8MB
+#define CACHE_BUDGET_8MB (3 * 1024 * 1024)
+#endif
+
+// time per frame spent loading files queued by the try_load calls, files
+// load whole so a single one can take longer
+#ifndef CACHE_QUEUE_TICKS
+#define CACHE_QUEUE_TICKS TICKS_FROM_MS(2)
+#endif
+
+// kinds of asset a map manifest lists, actors stand for their class's assets
+typedef enum {
+  AK_NONE,
+  AK_GFX,
+  AK_TILESET,
+  AK_MODEL,
+  AK_SFX,
+  AK_ACTOR,
+} asset_kind_t;
+
+typedef struct {
+  uint8_t kind;
+  uint16_t id;
+} asset_ref_t;
+
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t resident_bytes;
+  uint32_t retained_bytes; // part of resident that nobody holds
+  uint32_t retained_count;
+  uint32_t budget;
+} cache_stats_t;
+
+typedef struct {
+  uint32_t entries;
+  uint32_t bytes;
+  uint32_t refs;
+  uint32_t hits;
+  uint32_t misses;
+  uint64_t load_ticks;
+} cache_pool_stats_t;
+
+typedef struct {
+  uint8_t kind;
+  bool pinned;
+  uint16_t id;
+  uint32_t size;
+  uint32_t refcount; // 0 while retained
+} cache_entry_info_t;
+
+void cache_set_budget(uint32_t bytes);
+void cache_get_stats(cache_stats_t *stats);
+void cache_get_pool_stats(asset_kind_t kind, cache_pool_stats_t *stats);
+// fills in up to max resident files in pool and id order, returns the count
+size_t cache_list_resident(cache_entry_info_t *entries, size_t max);
+const char *cache_asset_path(asset_kind_t kind, uint16_t id);
+// a pinned file stays loaded after its last unload until it's unpinned
+void cache_set_pinned(asset_kind_t kind, uint16_t id, bool pinned);
+// loads whatever isn't resident in rom order and leaves it retained, stops
+// early once the budget is full. actors and sfx are skipped. pinned files
+// that aren't listed are unpinned first
+void cache_warm(asset_ref_t *assets, size_t count);
+void cache_service_queue(uint32_t budget_ticks);
+
 sprite_t *sprite_pool_load(int id);
 sprite_t *sprite_pool_load_gl(int id, GLuint *tex);
+// NULL until the file is resident, the load is queued meanwhile
+sprite_t *sprite_pool_try_load(int id);
 void sprite_pool_unload(sprite_t *sprite);
 
 GLuint model_pool_load(int id, size_t bufsize);
 void model_pool_unload(GLuint start_list);
 
 tiles_desc_t *tileset_pool_load(int id);
+tiles_desc_t *tileset_pool_try_load(int id);
 void tileset_pool_unload(tiles_desc_t *tiles);
 
 #ifdef __cplusplus
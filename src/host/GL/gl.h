@@ -0,0 +1,111 @@
+#pragma once
+
+// the fixed function subset the game uses, host builds record nothing
+
+#include <stdint.h>
+
+#include "../graphics.h"
+#include "../libdragon.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef unsigned int GLuint;
+typedef int GLsizei;
+typedef float GLfloat;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+
+#define GL_POINTS 0x0000
+#define GL_LINES 0x0001
+#define GL_LINE_LOOP 0x0002
+#define GL_QUADS 0x0007
+
+#define GL_GREATER 0x0204
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_FRONT_AND_BACK 0x0408
+#define GL_CULL_FACE 0x0B44
+#define GL_LIGHTING 0x0B50
+#define GL_LIGHT_MODEL_LOCAL_VIEWER 0x0B51
+#define GL_LIGHT_MODEL_AMBIENT 0x0B53
+#define GL_COLOR_MATERIAL 0x0B57
+#define GL_DEPTH_TEST 0x0B71
+#define GL_NORMALIZE 0x0BA1
+#define GL_ALPHA_TEST 0x0BC0
+#define GL_DITHER 0x0BD0
+#define GL_BLEND 0x0BE2
+#define GL_CCW 0x0901
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_FASTEST 0x1101
+#define GL_DIFFUSE 0x1201
+#define GL_POSITION 0x1203
+#define GL_LINEAR_ATTENUATION 0x1208
+#define GL_QUADRATIC_ATTENUATION 0x1209
+#define GL_COMPILE 0x1300
+#define GL_AMBIENT_AND_DIFFUSE 0x1602
+#define GL_MODELVIEW 0x1700
+#define GL_PROJECTION 0x1701
+#define GL_NEAREST 0x2600
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_LIGHT0 0x4000
+#define GL_MULTISAMPLE_ARB 0x809D
+#define GL_MULTISAMPLE_HINT_N64 0x6D10
+#define GL_LESS_INTERPENETRATING_N64 0x6D20
+
+void gl_init(void);
+void gl_context_begin(void);
+void gl_context_end(void);
+
+void glEnable(GLenum target);
+void glDisable(GLenum target);
+void glHint(GLenum target, GLenum hint);
+void glAlphaFunc(GLenum func, GLfloat ref);
+void glBlendFunc(GLenum src, GLenum dst);
+void glDepthFunc(GLenum func);
+void glFrontFace(GLenum dir);
+void glPointSize(GLfloat size);
+
+void glMatrixMode(GLenum mode);
+void glLoadIdentity(void);
+void glPushMatrix(void);
+void glPopMatrix(void);
+void glOrtho(double l, double r, double b, double t, double n, double f);
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void glScalef(GLfloat x, GLfloat y, GLfloat z);
+
+void glBegin(GLenum mode);
+void glEnd(void);
+void glVertex2f(GLfloat x, GLfloat y);
+void glVertex3i(GLint x, GLint y, GLint z);
+void glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+void glLightf(GLenum light, GLenum pname, GLfloat param);
+void glLightfv(GLenum light, GLenum pname, const GLfloat *params);
+void glLightModeli(GLenum pname, GLint param);
+void glLightModelfv(GLenum pname, const GLfloat *params);
+void glMaterialfv(GLenum face, GLenum pname, const GLfloat *params);
+void glColorMaterial(GLenum face, GLenum mode);
+
+void glGenTextures(GLsizei n, GLuint *textures);
+void glDeleteTextures(GLsizei n, const GLuint *textures);
+void glBindTexture(GLenum target, GLuint texture);
+void glTexParameteri(GLenum target, GLenum pname, GLint param);
+void glSpriteTextureN64(GLenum target, sprite_t *sprite, rdpq_texparms_t *texparms);
+
+GLuint glGenLists(GLsizei range);
+void glDeleteLists(GLuint list, GLsizei range);
+void glNewList(GLuint n, GLenum mode);
+void glEndList(void);
+void glCallList(GLuint list);
+
+#ifdef __cplusplus
+}
+#endif
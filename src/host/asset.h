@@ -0,0 +1,13 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// reads the whole file, rom:/ paths resolve under HOST_FILESYSTEM. host
+// assets are written uncompressed so there's nothing to unpack
+void *asset_load(const char *fn, int *sz);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <assert.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef NDEBUG
+#define assertf(expr, msg, ...) ((void) 0)
+#else
+#define assertf(expr, msg, ...) ({ \
+  if (!(expr)) \
+    debug_assert_func_f(__FILE__, __LINE__, __func__, #expr, msg, ##__VA_ARGS__); \
+})
+#endif
+
+#define debugf(msg, ...) fprintf(stderr, msg, ##__VA_ARGS__)
+
+void debug_assert_func_f(const char *file, int line, const char *func, const char *failedexpr, const char *msg, ...)
+  __attribute__((noreturn, format(printf, 5, 6)));
+
+bool debug_init_usblog(void);
+bool debug_init_isviewer(void);
+bool debug_init_sdfs(const char *prefix, int npart);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DFS_DEFAULT_LOCATION 0x10101000
+#define DFS_ESUCCESS 0
+
+int dfs_init(uint32_t base_fs_loc);
+// the host has no rom, this is only stable enough to sort by
+uint32_t dfs_rom_addr(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct __attribute__((aligned(4))) {
+  uint8_t r, g, b, a;
+} color_t;
+
+#define RGBA32(rx, gx, bx, ax) ((color_t) { .r = (rx), .g = (gx), .b = (bx), .a = (ax) })
+
+typedef enum {
+  FMT_NONE = 0,
+  FMT_RGBA16 = (0 << 2) | 2,
+  FMT_RGBA32 = (0 << 2) | 3,
+  FMT_CI4 = (2 << 2) | 0,
+  FMT_CI8 = (2 << 2) | 1,
+  FMT_IA8 = (3 << 2) | 1,
+  FMT_I8 = (4 << 2) | 1,
+} tex_format_t;
+
+#define TEX_FORMAT_BITDEPTH(fmt) (4 << ((fmt) & 0x3))
+#define TEX_FORMAT_PIX2BYTES(fmt, pixels) ((((pixels) << (((fmt) & 3) + 2)) + 7) >> 3)
+
+const char *tex_format_name(tex_format_t fmt);
+
+typedef struct surface_s {
+  uint16_t flags;
+  uint16_t width;
+  uint16_t height;
+  uint16_t stride;
+  void *buffer;
+} surface_t;
+
+surface_t surface_alloc(tex_format_t format, uint16_t width, uint16_t height);
+void surface_free(surface_t *surface);
+
+// host sprites are only the header, nothing is ever drawn
+typedef struct sprite_s {
+  uint16_t width;
+  uint16_t height;
+  uint8_t bitdepth;
+  uint8_t flags;
+  uint8_t hslices;
+  uint8_t vslices;
+  uint32_t data[];
+} sprite_t;
+
+sprite_t *sprite_load(const char *fn);
+void sprite_free(sprite_t *sprite);
+tex_format_t sprite_get_format(sprite_t *sprite);
+surface_t sprite_get_pixels(sprite_t *sprite);
+uint16_t *sprite_get_palette(sprite_t *sprite);
+
+typedef struct {
+  int32_t width;
+  int32_t height;
+  bool interlaced;
+} resolution_t;
+
+#define RESOLUTION_640x480 ((resolution_t) { 640, 480, true })
+
+typedef enum { DEPTH_16_BPP, DEPTH_32_BPP } bitdepth_t;
+typedef enum { GAMMA_NONE, GAMMA_CORRECT, GAMMA_CORRECT_DITHER } gamma_t;
+typedef enum { ANTIALIAS_OFF, ANTIALIAS_RESAMPLE, ANTIALIAS_RESAMPLE_FETCH_NEEDED, ANTIALIAS_RESAMPLE_FETCH_ALWAYS } filter_options_t;
+
+void display_init(resolution_t res, bitdepth_t bit, uint32_t num_buffers, gamma_t gamma, filter_options_t filters);
+void display_close(void);
+surface_t *display_get(void);
+void display_show(surface_t *surf);
+uint32_t display_get_width(void);
+uint32_t display_get_height(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,366 @@
+#include <libdragon.h>
+#include <model64.h>
+#include <GL/gl.h>
+#include <rdpq_text.h>
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// everything the game calls outside of map_tick is a no-op on the host. what
+// map_tick reads back (ticks, asset files, sprite sizes) behaves like the
+// console so the bench runs the same code paths
+
+#ifndef HOST_FILESYSTEM
+#define HOST_FILESYSTEM "build/host/filesystem"
+#endif
+
+static const char *host_path(const char *fn, char *buf, size_t size) {
+  const char *root = getenv("HOST_FILESYSTEM");
+  if (!root)
+    root = HOST_FILESYSTEM;
+  if (!strncmp(fn, "rom:", 4))
+    fn += 4;
+  snprintf(buf, size, "%s%s%s", root, *fn == '/' ? "" : "/", fn);
+  return buf;
+}
+
+static FILE *host_open(const char *fn) {
+  char path[512];
+  FILE *f = fopen(host_path(fn, path, sizeof path), "rb");
+  assertf(f != NULL, "failed to open %s", path);
+  return f;
+}
+
+uint32_t get_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t ns = (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+  return (uint32_t) (ns * (TICKS_PER_SECOND / 1000) / 1000000);
+}
+
+int get_memory_size(void) {
+  return is_memory_expanded() ? 0x800000 : 0x400000;
+}
+
+bool is_memory_expanded(void) {
+  // HOST_MEMORY=4 benches the cache budget of a console without the pak
+  const char *mem = getenv("HOST_MEMORY");
+  return !mem || atoi(mem) != 4;
+}
+
+long long exception_reset_time(void) {
+  return 0;
+}
+
+void debug_assert_func_f(const char *file, int line, const char *func, const char *failedexpr, const char *msg, ...) {
+  fprintf(stderr, "assertion failed: %s\n%s:%d (%s)\n", failedexpr, file, line, func);
+  if (msg) {
+    va_list args;
+    va_start(args, msg);
+    vfprintf(stderr, msg, args);
+    va_end(args);
+    fputc('\n', stderr);
+  }
+  abort();
+}
+
+bool debug_init_usblog(void) { return true; }
+bool debug_init_isviewer(void) { return true; }
+bool debug_init_sdfs(const char *prefix, int npart) { return false; }
+
+// ********** FILESYSTEM **********
+
+int dfs_init(uint32_t base_fs_loc) {
+  return DFS_ESUCCESS;
+}
+
+uint32_t dfs_rom_addr(const char *path) {
+  uint32_t hash = 2166136261u;
+  for (; *path; path++)
+    hash = (hash ^ (uint8_t) *path) * 16777619u;
+  return hash;
+}
+
+void *asset_load(const char *fn, int *sz) {
+  FILE *f = host_open(fn);
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  void *data = malloc(size);
+  assertf(data != NULL, "out of memory");
+  assertf(fread(data, 1, size, f) == (size_t) size, "failed to read %s", fn);
+  fclose(f);
+  if (sz)
+    *sz = size;
+  return data;
+}
+
+// ********** GRAPHICS **********
+
+static surface_t host_screen;
+
+const char *tex_format_name(tex_format_t fmt) {
+  switch (fmt) {
+  case FMT_RGBA16: return "RGBA16";
+  case FMT_RGBA32: return "RGBA32";
+  case FMT_CI4: return "CI4";
+  case FMT_CI8: return "CI8";
+  case FMT_IA8: return "IA8";
+  case FMT_I8: return "I8";
+  default: return "FMT_NONE";
+  }
+}
+
+// no pixels are kept, surfaces only carry their size
+surface_t surface_alloc(tex_format_t format, uint16_t width, uint16_t height) {
+  return (surface_t) {
+    .flags = format,
+    .width = width,
+    .height = height,
+    .stride = TEX_FORMAT_PIX2BYTES(format, width),
+  };
+}
+
+void surface_free(surface_t *surface) {
+  memset(surface, 0, sizeof *surface);
+}
+
+// reads the big endian header mksprite writes and drops the pixels
+sprite_t *sprite_load(const char *fn) {
+  uint8_t header[8];
+  FILE *f = host_open(fn);
+  assertf(fread(header, 1, sizeof header, f) == sizeof header, "failed to read %s", fn);
+  fclose(f);
+  assertf(memcmp(header, "DCA", 3), "%s is compressed, host sprites are built with --compress 0", fn);
+  sprite_t *sprite = calloc(1, sizeof(sprite_t));
+  assertf(sprite != NULL, "out of memory");
+  sprite->width = (header[0] << 8) | header[1];
+  sprite->height = (header[2] << 8) | header[3];
+  sprite->bitdepth = header[4];
+  sprite->flags = header[5];
+  sprite->hslices = header[6];
+  sprite->vslices = header[7];
+  return sprite;
+}
+
+void sprite_free(sprite_t *sprite) {
+  free(sprite);
+}
+
+tex_format_t sprite_get_format(sprite_t *sprite) {
+  return (tex_format_t) (sprite->flags & 0x1f);
+}
+
+surface_t sprite_get_pixels(sprite_t *sprite) {
+  tex_format_t fmt = sprite_get_format(sprite);
+  return (surface_t) {
+    .flags = fmt,
+    .width = sprite->width,
+    .height = sprite->height,
+    .stride = TEX_FORMAT_PIX2BYTES(fmt, sprite->width),
+  };
+}
+
+uint16_t *sprite_get_palette(sprite_t *sprite) {
+  static uint16_t palette[256];
+  return palette;
+}
+
+void display_init(resolution_t res, bitdepth_t bit, uint32_t num_buffers, gamma_t gamma, filter_options_t filters) {
+  host_screen = surface_alloc(bit == DEPTH_32_BPP ? FMT_RGBA32 : FMT_RGBA16, res.width, res.height);
+}
+
+void display_close(void) {}
+surface_t *display_get(void) { return &host_screen; }
+void display_show(surface_t *surf) {}
+uint32_t display_get_width(void) { return host_screen.width; }
+uint32_t display_get_height(void) { return host_screen.height; }
+
+struct model64_s {
+  int unused;
+};
+
+model64_t *model64_load(const char *fn) {
+  model64_t *model = calloc(1, sizeof(model64_t));
+  assertf(model != NULL, "out of memory");
+  return model;
+}
+
+void model64_free(model64_t *model) { free(model); }
+uint32_t model64_get_mesh_count(model64_t *model) { return 0; }
+mesh_t *model64_get_mesh(model64_t *model, uint32_t mesh_index) { return NULL; }
+void model64_draw_mesh(mesh_t *mesh) {}
+
+// ********** INPUT AND TIMING **********
+
+void controller_init(void) {}
+void controller_scan(void) {}
+struct controller_data get_keys_down(void) { return (struct controller_data) {}; }
+struct controller_data get_keys_pressed(void) { return (struct controller_data) {}; }
+
+void throttle_init(float fps, int can_frameskip, int frames_advance) {}
+int throttle_wait(void) { return 0; }
+int throttle_frame_time_left(void) { return 0; }
+
+// ********** AUDIO **********
+
+// sounds have no length on the host so they're over as soon as they start
+void audio_init(const int frequency, int numbuffers) {}
+void audio_close(void) {}
+void audio_set_buffer_callback(void (*fill_buffer_callback)(short *buffer, size_t numsamples)) {}
+int audio_can_write(void) { return 0; }
+short *audio_write_begin(void) { return NULL; }
+void audio_write_end(void) {}
+int audio_get_buffer_length(void) { return 0; }
+
+void mixer_init(int num_channels) {}
+void mixer_poll(int16_t *out, int nsamples) {}
+void mixer_ch_set_vol(int ch, float lvol, float rvol) {}
+void mixer_ch_stop(int ch) {}
+bool mixer_ch_playing(int ch) { return false; }
+float mixer_ch_get_pos(int ch) { return 0; }
+void mixer_ch_set_pos(int ch, float pos) {}
+
+void wav64_open(wav64_t *wav, const char *fn) {
+  memset(wav, 0, sizeof *wav);
+  wav->wave.name = fn;
+  wav->wave.bits = 8;
+  wav->wave.channels = 1;
+  wav->wave.frequency = 32000;
+}
+
+void wav64_play(wav64_t *wav, int ch) {}
+
+void xm64player_open(xm64player_t *player, const char *fn) {
+  static int ctx;
+  player->ctx = &ctx;
+}
+
+int xm64player_num_channels(xm64player_t *player) { return 0; }
+void xm64player_play(xm64player_t *player, int first_ch) {}
+void xm64player_set_loop(xm64player_t *player, bool loop) {}
+void xm64player_set_vol(xm64player_t *player, float volume) {}
+void xm64player_close(xm64player_t *player) { player->ctx = NULL; }
+
+// ********** RDPQ **********
+
+const rdpq_trifmt_t TRIFMT_SHADE = { .pos_offset = 0 };
+const rdpq_trifmt_t TRIFMT_ZBUF_TEX = { .pos_offset = 0 };
+
+void rdpq_init(void) {}
+void rspq_wait(void) {}
+void rdpq_attach(const surface_t *surf_color, const surface_t *surf_z) {}
+void rdpq_attach_clear(const surface_t *surf_color, const surface_t *surf_z) {}
+void rdpq_detach(void) {}
+void rdpq_detach_show(void) {}
+void rdpq_detach_wait(void) {}
+void rdpq_sync_pipe(void) {}
+void rdpq_sync_tile(void) {}
+void rdpq_clear_z(uint16_t z) {}
+void rdpq_set_mode_standard(void) {}
+void rdpq_set_mode_copy(bool transparency) {}
+void rdpq_set_mode_fill(color_t color) {}
+void rdpq_set_prim_color(color_t color) {}
+void rdpq_mode_begin(void) {}
+void rdpq_mode_end(void) {}
+void rdpq_mode_push(void) {}
+void rdpq_mode_pop(void) {}
+void rdpq_mode_combiner(rdpq_combiner_t comb) {}
+void rdpq_mode_blender(rdpq_blender_t blend) {}
+void rdpq_mode_tlut(rdpq_tlut_t tlut) {}
+void rdpq_mode_persp(bool perspective) {}
+void rdpq_mode_zbuf(bool compare, bool update) {}
+void rdpq_mode_zoverride(bool enable, float z, int16_t deltaz) {}
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1) {}
+void rdpq_texture_rectangle(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s, float t) {}
+void rdpq_texture_rectangle_flip(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s, float t) {}
+void rdpq_triangle(const rdpq_trifmt_t *fmt, const float *v1, const float *v2, const float *v3) {}
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t *tex, const rdpq_texparms_t *parms) { return 0; }
+int rdpq_tex_upload_sub(rdpq_tile_t tile, const surface_t *tex, const rdpq_texparms_t *parms, int s0, int t0, int s1, int t1) { return 0; }
+void rdpq_tex_upload_tlut(uint16_t *tlut, int color_idx, int num_colors) {}
+void rdpq_tex_blit(const surface_t *surf, float x0, float y0, const rdpq_blitparms_t *parms) {}
+int rdpq_sprite_upload(rdpq_tile_t tile, sprite_t *sprite, const rdpq_texparms_t *parms) { return 0; }
+void rdpq_sprite_blit(sprite_t *sprite, float x0, float y0, const rdpq_blitparms_t *parms) {}
+
+struct rdpq_font_s {
+  int unused;
+};
+
+static const rdpq_font_t *host_fonts[256];
+
+rdpq_font_t *rdpq_font_load(const char *fn) {
+  rdpq_font_t *font = calloc(1, sizeof(rdpq_font_t));
+  assertf(font != NULL, "out of memory");
+  return font;
+}
+
+void rdpq_font_style(rdpq_font_t *font, uint8_t style_id, const rdpq_fontstyle_t *style) {}
+void rdpq_text_register_font(uint8_t font_id, const rdpq_font_t *font) { host_fonts[font_id] = font; }
+const rdpq_font_t *rdpq_text_get_font(uint8_t font_id) { return host_fonts[font_id]; }
+int rdpq_text_printn(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_text, int nbytes) { return 0; }
+int rdpq_text_print(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_text) { return 0; }
+int rdpq_text_printf(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_fmt, ...) { return 0; }
+
+// ********** GL **********
+
+static GLuint host_next_list = 1;
+static GLuint host_next_texture = 1;
+
+void gl_init(void) {}
+void gl_context_begin(void) {}
+void gl_context_end(void) {}
+
+void glEnable(GLenum target) {}
+void glDisable(GLenum target) {}
+void glHint(GLenum target, GLenum hint) {}
+void glAlphaFunc(GLenum func, GLfloat ref) {}
+void glBlendFunc(GLenum src, GLenum dst) {}
+void glDepthFunc(GLenum func) {}
+void glFrontFace(GLenum dir) {}
+void glPointSize(GLfloat size) {}
+
+void glMatrixMode(GLenum mode) {}
+void glLoadIdentity(void) {}
+void glPushMatrix(void) {}
+void glPopMatrix(void) {}
+void glOrtho(double l, double r, double b, double t, double n, double f) {}
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z) {}
+void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {}
+void glScalef(GLfloat x, GLfloat y, GLfloat z) {}
+
+void glBegin(GLenum mode) {}
+void glEnd(void) {}
+void glVertex2f(GLfloat x, GLfloat y) {}
+void glVertex3i(GLint x, GLint y, GLint z) {}
+void glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {}
+
+void glLightf(GLenum light, GLenum pname, GLfloat param) {}
+void glLightfv(GLenum light, GLenum pname, const GLfloat *params) {}
+void glLightModeli(GLenum pname, GLint param) {}
+void glLightModelfv(GLenum pname, const GLfloat *params) {}
+void glMaterialfv(GLenum face, GLenum pname, const GLfloat *params) {}
+void glColorMaterial(GLenum face, GLenum mode) {}
+
+void glGenTextures(GLsizei n, GLuint *textures) {
+  for (GLsizei i = 0; i < n; i++)
+    textures[i] = host_next_texture++;
+}
+
+void glDeleteTextures(GLsizei n, const GLuint *textures) {}
+void glBindTexture(GLenum target, GLuint texture) {}
+void glTexParameteri(GLenum target, GLenum pname, GLint param) {}
+void glSpriteTextureN64(GLenum target, sprite_t *sprite, rdpq_texparms_t *texparms) {}
+
+// the cache keys models by their first list, so ids are never reused
+GLuint glGenLists(GLsizei range) {
+  GLuint list = host_next_list;
+  host_next_list += range ? range : 1;
+  return list;
+}
+
+void glDeleteLists(GLuint list, GLsizei range) {}
+void glNewList(GLuint n, GLenum mode) {}
+void glEndList(void) {}
+void glCallList(GLuint list) {}
@@ -0,0 +1,221 @@
+#pragma once
+
+// the parts of libdragon the game uses, for headless host builds. drawing,
+// audio and input are no-ops, see host.c
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset.h"
+#include "debug.h"
+#include "dfs.h"
+#include "graphics.h"
+#include "model64.h"
+#include "n64sys.h"
+#include "rdpq_text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ********** CONTROLLER **********
+
+struct SI_condat {
+  unsigned : 16;
+  unsigned err : 2;
+  unsigned : 14;
+  union {
+    struct {
+      unsigned int data : 32;
+    };
+    struct {
+      unsigned A : 1;
+      unsigned B : 1;
+      unsigned Z : 1;
+      unsigned start : 1;
+      unsigned up : 1;
+      unsigned down : 1;
+      unsigned left : 1;
+      unsigned right : 1;
+      unsigned : 2;
+      unsigned L : 1;
+      unsigned R : 1;
+      unsigned C_up : 1;
+      unsigned C_down : 1;
+      unsigned C_left : 1;
+      unsigned C_right : 1;
+      signed x : 8;
+      signed y : 8;
+    };
+  };
+};
+
+struct controller_data {
+  struct SI_condat c[4];
+};
+
+void controller_init(void);
+void controller_scan(void);
+struct controller_data get_keys_down(void);
+struct controller_data get_keys_pressed(void);
+
+// ********** TIMING **********
+
+void throttle_init(float fps, int can_frameskip, int frames_advance);
+int throttle_wait(void);
+int throttle_frame_time_left(void);
+
+// ********** AUDIO **********
+
+typedef struct samplebuffer_s samplebuffer_t;
+typedef void (*WaveformRead)(void *ctx, samplebuffer_t *sbuf, int wpos, int wlen, bool seeking);
+typedef void (*WaveformStart)(void *ctx, samplebuffer_t *sbuf);
+
+typedef struct {
+  const char *name;
+  uint8_t bits;
+  uint8_t channels;
+  float frequency;
+  int len;
+  int loop_len;
+  WaveformRead read;
+  WaveformStart start;
+  void *ctx;
+} waveform_t;
+
+typedef struct {
+  waveform_t wave;
+} wav64_t;
+
+typedef struct {
+  void *ctx;
+} xm64player_t;
+
+void audio_init(const int frequency, int numbuffers);
+void audio_close(void);
+void audio_set_buffer_callback(void (*fill_buffer_callback)(short *buffer, size_t numsamples));
+int audio_can_write(void);
+short *audio_write_begin(void);
+void audio_write_end(void);
+int audio_get_buffer_length(void);
+
+void mixer_init(int num_channels);
+void mixer_poll(int16_t *out, int nsamples);
+void mixer_ch_set_vol(int ch, float lvol, float rvol);
+void mixer_ch_stop(int ch);
+bool mixer_ch_playing(int ch);
+float mixer_ch_get_pos(int ch);
+void mixer_ch_set_pos(int ch, float pos);
+
+void wav64_open(wav64_t *wav, const char *fn);
+void wav64_play(wav64_t *wav, int ch);
+
+void xm64player_open(xm64player_t *player, const char *fn);
+int xm64player_num_channels(xm64player_t *player);
+void xm64player_play(xm64player_t *player, int first_ch);
+void xm64player_set_loop(xm64player_t *player, bool loop);
+void xm64player_set_vol(xm64player_t *player, float volume);
+void xm64player_close(xm64player_t *player);
+
+// ********** RDPQ **********
+
+typedef enum { TILE0, TILE1, TILE2, TILE3, TILE4, TILE5, TILE6, TILE7 } rdpq_tile_t;
+typedef enum { TLUT_NONE, TLUT_RGBA16, TLUT_IA16 } rdpq_tlut_t;
+typedef uint64_t rdpq_combiner_t;
+typedef uint32_t rdpq_blender_t;
+
+// the combiner and blender formulas are thrown away
+#define RDPQ_COMBINER1(rgb, alpha) ((rdpq_combiner_t) 0)
+#define RDPQ_COMBINER_FLAT ((rdpq_combiner_t) 0)
+#define RDPQ_COMBINER_TEX_FLAT ((rdpq_combiner_t) 0)
+#define RDPQ_BLENDER_MULTIPLY ((rdpq_blender_t) 0)
+
+#define REPEAT_INFINITE 2048
+
+typedef struct {
+  int pos_offset;
+  int shade_offset;
+  bool shade_flat;
+  int tex_offset;
+  rdpq_tile_t tex_tile;
+  int tex_mipmaps;
+  int z_offset;
+} rdpq_trifmt_t;
+
+extern const rdpq_trifmt_t TRIFMT_SHADE;
+extern const rdpq_trifmt_t TRIFMT_ZBUF_TEX;
+
+typedef struct {
+  rdpq_tile_t tile;
+  int s0;
+  int t0;
+  int width;
+  int height;
+  bool flip_x;
+  bool flip_y;
+  int cx;
+  int cy;
+  float scale_x;
+  float scale_y;
+  float theta;
+  bool filtering;
+  int nx;
+  int ny;
+} rdpq_blitparms_t;
+
+typedef struct {
+  int tmem_addr;
+  int palette;
+  struct {
+    float translate;
+    int scale_log;
+    float repeats;
+    bool mirror;
+  } s, t;
+} rdpq_texparms_t;
+
+void rdpq_init(void);
+void rspq_wait(void);
+void rdpq_attach(const surface_t *surf_color, const surface_t *surf_z);
+void rdpq_attach_clear(const surface_t *surf_color, const surface_t *surf_z);
+void rdpq_detach(void);
+void rdpq_detach_show(void);
+void rdpq_detach_wait(void);
+void rdpq_sync_pipe(void);
+void rdpq_sync_tile(void);
+void rdpq_clear_z(uint16_t z);
+
+void rdpq_set_mode_standard(void);
+void rdpq_set_mode_copy(bool transparency);
+void rdpq_set_mode_fill(color_t color);
+void rdpq_set_prim_color(color_t color);
+void rdpq_mode_begin(void);
+void rdpq_mode_end(void);
+void rdpq_mode_push(void);
+void rdpq_mode_pop(void);
+void rdpq_mode_combiner(rdpq_combiner_t comb);
+void rdpq_mode_blender(rdpq_blender_t blend);
+void rdpq_mode_tlut(rdpq_tlut_t tlut);
+void rdpq_mode_persp(bool perspective);
+void rdpq_mode_zbuf(bool compare, bool update);
+void rdpq_mode_zoverride(bool enable, float z, int16_t deltaz);
+
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1);
+void rdpq_texture_rectangle(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s, float t);
+void rdpq_texture_rectangle_flip(rdpq_tile_t tile, float x0, float y0, float x1, float y1, float s, float t);
+void rdpq_triangle(const rdpq_trifmt_t *fmt, const float *v1, const float *v2, const float *v3);
+
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t *tex, const rdpq_texparms_t *parms);
+int rdpq_tex_upload_sub(rdpq_tile_t tile, const surface_t *tex, const rdpq_texparms_t *parms, int s0, int t0, int s1, int t1);
+void rdpq_tex_upload_tlut(uint16_t *tlut, int color_idx, int num_colors);
+void rdpq_tex_blit(const surface_t *surf, float x0, float y0, const rdpq_blitparms_t *parms);
+int rdpq_sprite_upload(rdpq_tile_t tile, sprite_t *sprite, const rdpq_texparms_t *parms);
+void rdpq_sprite_blit(sprite_t *sprite, float x0, float y0, const rdpq_blitparms_t *parms);
+
+#ifdef __cplusplus
+}
+#endif
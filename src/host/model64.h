@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// host models have no meshes, display lists are never drawn
+typedef struct model64_s model64_t;
+typedef struct mesh_s mesh_t;
+
+model64_t *model64_load(const char *fn);
+void model64_free(model64_t *model);
+uint32_t model64_get_mesh_count(model64_t *model);
+mesh_t *model64_get_mesh(model64_t *model, uint32_t mesh_index);
+void model64_draw_mesh(mesh_t *mesh);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// same tick rate as the console so the game's timing maths doesn't change
+#define TICKS_PER_SECOND (93750000 / 2)
+#define TICKS_FROM_MS(val) ((uint32_t) ((val) * (TICKS_PER_SECOND / 1000)))
+#define TICKS_TO_MS(val) (((uint32_t) (val)) / (TICKS_PER_SECOND / 1000))
+#define TICKS_DISTANCE(from, to) ((int32_t) ((uint32_t) (to) - (uint32_t) (from)))
+#define TICKS_READ() get_ticks()
+
+// the game tells map offsets from pointers by comparing against the start of
+// kseg0. offsets in asset files stay well below this and host heap pointers
+// are above it
+#define KSEG0_START_ADDR ((void *) 0x01000000)
+
+#define C1_ENABLE_UNDERFLOW 0x00000100
+#define C1_ENABLE_OVERFLOW 0x00000200
+#define C1_FCR31() 0u
+#define C1_WRITE_FCR31(x) ((void) (x))
+
+uint32_t get_ticks(void);
+int get_memory_size(void);
+bool is_memory_expanded(void);
+long long exception_reset_time(void);
+
+#ifdef __cplusplus
+}
+#endif
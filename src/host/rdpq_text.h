@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT } rdpq_align_t;
+typedef enum { VALIGN_TOP, VALIGN_CENTER, VALIGN_BOTTOM } rdpq_valign_t;
+typedef enum { WRAP_NONE, WRAP_ELLIPSES, WRAP_CHAR, WRAP_WORD } rdpq_textwrap_t;
+
+typedef struct {
+  int16_t width;
+  int16_t height;
+  rdpq_align_t align;
+  rdpq_valign_t valign;
+  int16_t indent;
+  int16_t char_spacing;
+  int16_t line_spacing;
+  rdpq_textwrap_t wrap;
+} rdpq_textparms_t;
+
+typedef struct rdpq_font_s rdpq_font_t;
+
+typedef struct {
+  color_t color;
+} rdpq_fontstyle_t;
+
+rdpq_font_t *rdpq_font_load(const char *fn);
+void rdpq_font_style(rdpq_font_t *font, uint8_t style_id, const rdpq_fontstyle_t *style);
+void rdpq_text_register_font(uint8_t font_id, const rdpq_font_t *font);
+const rdpq_font_t *rdpq_text_get_font(uint8_t font_id);
+int rdpq_text_printn(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_text, int nbytes);
+int rdpq_text_print(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_text);
+int rdpq_text_printf(const rdpq_textparms_t *parms, uint8_t font_id, float x0, float y0, const char *utf8_fmt, ...)
+  __attribute__((format(printf, 5, 6)));
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,11 +1,13 @@
 #include <libdragon.h>
 #include <model64.h>
+#include <inttypes.h>
 
 #include "main.h"
 #include "assets.h"
 #include "map.h"
 #include "menu.h"
 #include "render.h"
+#include "replay.h"
 #include "sound.h"
 #include "util.h"
 
@@ -17,6 +19,11 @@
 static void run_intro(void);
 static global_state_t game_loop(void);
 static void reset_fade(void);
+#ifdef MAP_BENCH
+static void run_bench(void);
+#elif defined(HOST_BUILD)
+#error "the host build only runs MAP_BENCH"
+#endif
 
 static map_t current_map = { .header = NULL };
 
@@ -40,6 +47,9 @@ int main(void) {
     int ret = dfs_init(DFS_DEFAULT_LOCATION);
     assertf(ret == DFS_ESUCCESS, "failed to initialize dfs");
   }
+#ifdef REPLAY
+  replay_init();
+#endif
 
   render_init();
   sound_init();
@@ -62,13 +72,25 @@ int main(void) {
 
   sound_play_music(MUS_OUTDOOR, 0, 0);
 
+#ifdef MAP_BENCH
+  run_bench();
+#ifdef HOST_BUILD
+  return 0;
+#endif
+#endif
+
   global_state_t state = ST_MAIN_MENU;
   while (true) {
     switch (state) {
     case ST_MAIN_MENU:
-      map_load(maps_paths[INIT_MAP], &current_map, MSF_PLAYER_CONTROL);
       current_map.map_id = INIT_MAP;
+      map_load(maps_paths[INIT_MAP], &current_map, MSF_PLAYER_CONTROL);
+#ifdef REPLAY
+      // the menu isn't logged, recordings start straight in the game
+      state = ST_GAME;
+#else
       state = main_menu_loop(&current_map);
+#endif
       break;
     case ST_GAME:
       state = game_loop();
@@ -95,6 +117,7 @@ static global_state_t game_loop(void) {
   surface_t *screen = NULL;
 
   while (true) {
+    replay_frame_begin();
     screen = display_get();
     rdpq_attach(screen, &zbuffer);
     render_scene(&current_map);
@@ -102,12 +125,14 @@ static global_state_t game_loop(void) {
     rdpq_detach_show();
     sound_tick();
 
+    replay_frame_pause();
     if (!throttle_wait()) {
       int32_t time_left = throttle_frame_time_left();
       if (time_left < 0) {
         lag_time += time_left;
       }
     }
+    replay_frame_resume();
 
     controller_scan();
 
@@ -117,10 +142,12 @@ static global_state_t game_loop(void) {
       sound_tick();
       if (next_state == ST_PAUSE || next_state == ST_RESET)
         grab_screen(screen);
-      if (next_state == ST_NEW_MAP)
+      if (next_state == ST_NEW_MAP) {
+        replay_frame_end(&current_map);
         map_transition(&current_map, screen);
-      else if (next_state != ST_GAME)
+      } else if (next_state != ST_GAME) {
         return next_state;
+      }
       if (lag_time > (FRAME_TICKS * 2)) {
         lag_time -= FRAME_TICKS;
         controller_scan();
@@ -132,8 +159,47 @@ static global_state_t game_loop(void) {
         break;
       }
     }
+    replay_frame_end(&current_map);
+  }
+}
+
+#ifdef MAP_BENCH
+// ticks every map MAP_BENCH frames without rendering or audio, pair it with
+// REPLAY=play to drive the player
+static void run_bench(void) {
+  static const char * const section_names[MB_COUNT] = {
+    [MB_MAP] = "map",
+    [MB_SCRIPTS] = "scripts",
+    [MB_CAMERA] = "camera",
+    [MB_SPAWNS] = "spawns",
+    [MB_PHYSICS] = "physics",
+    [MB_ACTORS] = "actors",
+    [MB_PARTICLES] = "particles",
+    [MB_ASSETS] = "assets",
+    [MB_GRID] = "grid",
+  };
+  // id 0 is the MAPS_NONE placeholder
+  for (uint32_t id = 1; id < NUM_MAPS; id++) {
+    current_map.map_id = id;
+    map_load(maps_paths[id], &current_map, MSF_PLAYER_CONTROL);
+    memset(current_map.bench_ticks, 0, sizeof current_map.bench_ticks);
+    uint32_t frames = 0;
+    uint32_t start = get_ticks();
+    while (frames < MAP_BENCH) {
+      global_state_t state = map_tick(&current_map);
+      frames++;
+      if (state == ST_NEW_MAP || state == ST_RESET)
+        break;
+    }
+    uint32_t ticks = get_ticks() - start;
+    debugf("bench: %s %" PRIu32 " frames, %.1f ticks/s\n",
+        maps_paths[id], frames, frames * (float) TICKS_PER_SECOND / ticks);
+    for (size_t i = 0; i < MB_COUNT; i++)
+      debugf("  %-10s %.3fms/frame\n", section_names[i],
+          current_map.bench_ticks[i] * (1000.0 / TICKS_PER_SECOND) / frames);
   }
 }
+#endif
 
 void change_vid_mode(bool wide, map_t *map) {
   resolution_t res = {wide ? 428 : 320, 240, false};
@@ -4,42 +4,104 @@
 #include <float.h>
 
 #include "actors.h"
+#include "assets.h"
 #include "cache.h"
 #include "main.h"
 #include "map.h"
 #include "player.h"
 #include "render.h"
+#include "replay.h"
 #include "sound.h"
 #include "util.h"
 
 #define MAP_MAGIC 0x544d4150 // TMAP
 
+#ifdef MAP_BENCH
+// charges the ticks since the last mark to a part of map_tick
+#define MAP_BENCH_MARK(section) do { \
+    uint32_t _now = get_ticks(); \
+    map->bench_ticks[(section)] += _now - map->bench_mark; \
+    map->bench_mark = _now; \
+  } while (0)
+#else
+#define MAP_BENCH_MARK(section) do {} while (0)
+#endif
+
 #define NO_WATER ((int32_t) 0x80000000)
 #define INVALID_FRAME ((uint16_t) 0xffff)
 
 #define PROP_UNLOAD_FRAMES 60
 
 static void map_tick_props(map_t *map, const irect2_t *rect, tile_chunk_t *chunk);
+static void map_activate_spawns(map_t *map);
+static void map_tick_timers(map_t *map);
 static void particle_destroy(particle_t *particle);
 
 extern inline void *map_get_pointer(map_t *map, uintptr_t ptr);
 
 // ********** MAP LOAD **********
 
+// loads everything the map can show up front so nothing hitches the first
+// time it appears. actors are listed by type and stand for their class's
+// assets, maps with water can always splash
+static void map_warm_cache(map_header_t *header) {
+  size_t count = 2;
+  for (asset_ref_t *ref = header->manifest; ref->kind != AK_NONE; ref++) {
+    count++;
+    if (ref->kind == AK_ACTOR && ref->id < actor_class_count) {
+      count += 2;
+      for (const asset_ref_t *extra = actor_classes[ref->id].assets; extra && extra->kind != AK_NONE; extra++)
+        count++;
+    }
+  }
+  asset_ref_t *assets = malloc(count * sizeof(asset_ref_t));
+  assertf(assets != NULL, "out of memory");
+  count = 0;
+  for (asset_ref_t *ref = header->manifest; ref->kind != AK_NONE; ref++) {
+    if (ref->kind != AK_ACTOR) {
+      assets[count++] = *ref;
+      continue;
+    }
+    if (ref->id >= actor_class_count)
+      continue;
+    const actor_class_t *cls = &actor_classes[ref->id];
+    assets[count++] = (asset_ref_t) { AK_GFX, cls->gfx_id };
+    assets[count++] = (asset_ref_t) { AK_TILESET, cls->tiles_id };
+    for (const asset_ref_t *extra = cls->assets; extra && extra->kind != AK_NONE; extra++)
+      assets[count++] = *extra;
+  }
+  if (header->water_line != NO_WATER) {
+    assets[count++] = (asset_ref_t) { AK_GFX, GFX_SPLASH };
+    assets[count++] = (asset_ref_t) { AK_TILESET, TILESET_SPLASH };
+  }
+  cache_warm(assets, count);
+  free(assets);
+}
+
 void map_load(const char *filename, map_t *map, uint32_t state_flags) {
-  if (map->header)
+  if (map->header) {
+    uint32_t map_id = map->map_id;
     map_unload(map);
+    map->map_id = map_id;
+  }
   uint8_t *data = asset_load(filename, NULL);
   map_header_t *header = (void *) data;
   assertf(header->magic == MAP_MAGIC, "%s not a valid map", filename);
 
   map->header = header;
+#if defined(REPLAY)
+  uint32_t seed = replay_seed() + map->map_id;
+#elif defined(MAP_BENCH)
+  uint32_t seed = REPLAY_SEED + map->map_id;
+#else
+  uint32_t seed = get_ticks();
+#endif
   map->rng = PCG32_INITIALIZER;
-  map->rng.inc += get_ticks();
-  map->rng.state -= get_ticks();
+  map->rng.inc += seed;
+  map->rng.state -= seed;
   map->render_rng = PCG32_INITIALIZER;
-  map->rng.inc += get_ticks() * 2;
-  map->rng.state -= get_ticks() * 2;
+  map->render_rng.inc += seed * 2;
+  map->render_rng.state -= seed * 2;
   map->lower_x = header->lower_x;
   map->lower_y = header->lower_y;
   map->width = header->width;
@@ -57,9 +119,21 @@ void map_load(const char *filename, map_t *map, uint32_t state_flags) {
 
   LIST_INIT(&map->actors);
   LIST_INIT(&map->dead);
+  LIST_INIT(&map->tickers);
+  LIST_INIT(&map->drawables);
+  LIST_INIT(&map->sounding);
   LIST_INIT(&map->particles);
   STAILQ_INIT(&map->active_props);
   TAILQ_INIT(&map->active_scripts);
+  script_sched_init(map);
+
+  if (header->manifest_offset) {
+    header->manifest = (asset_ref_t *) &data[header->manifest_offset];
+    map_warm_cache(header);
+  } else {
+    // still lets go of what the last map pinned
+    cache_warm(NULL, 0);
+  }
 
   tile_chunk_t **chunks = (tile_chunk_t **) &map->bgs[header->bg_count];
   for (size_t i = 0; i < header->tileset_count; i++) {
@@ -78,12 +152,18 @@ void map_load(const char *filename, map_t *map, uint32_t state_flags) {
   }
   map->chunks = calloc(header->width * header->height, sizeof(tile_chunk_t *));
   assertf(map->chunks != NULL, "out of memory");
+  map->actor_grid = malloc(header->width * header->height * sizeof(struct actor_cell_s));
+  assertf(map->actor_grid != NULL, "out of memory");
+  for (size_t i = 0; i < header->width * header->height; i++)
+    LIST_INIT(&map->actor_grid[i]);
   for (size_t i = 0; i < header->chunk_count; i++) {
     tile_chunk_t *chunk = (tile_chunk_t *) &data[(uintptr_t) chunks[i]];
     chunk->props = (prop_t **) &data[chunk->prop_offset];
     for (size_t i = 0; i < chunk->prop_count; i++) {
       chunk->props[i] = (prop_t *) &data[(uintptr_t) chunk->props[i]];
     }
+    if (chunk->spawn_count)
+      chunk->spawns = (uint16_t *) &data[chunk->spawn_offset];
     size_t index = (chunk->y - map->lower_y) * header->width + chunk->x - map->lower_x;
     map->chunks[index] = chunk;
   }
@@ -121,22 +201,34 @@ void map_load(const char *filename, map_t *map, uint32_t state_flags) {
     header->scripts = (script_t **) &data[header->scripts_offset];
     for (size_t i = 0; i < header->script_count; i++)
       header->scripts[i] = (script_t *) &data[(uintptr_t) header->scripts[i]];
+    map->script_instances = malloc(header->script_count * sizeof(script_queue_t));
+    assertf(map->script_instances != NULL, "out of memory");
+    for (size_t i = 0; i < header->script_count; i++)
+      TAILQ_INIT(&map->script_instances[i]);
   }
 
   if (header->actor_spawn_count) {
     header->actor_spawns = (actor_spawn_t *) &data[header->actor_spawns_offset];
-    for (size_t i = header->actor_spawn_count; i > 0; i--) {
-      actor_spawn_t *spawn = &header->actor_spawns[i - 1];
-      if (i - 1 < header->actor_spawn_init_count)
-        actor_spawn(map, spawn);
-    }
+    // the rest of the initial spawns wait until their chunk comes into range
+    for (size_t i = header->actor_spawn_eager_count; i > 0; i--)
+      actor_spawn(map, &header->actor_spawns[i - 1]);
+    map->spawned_mask = calloc((header->actor_spawn_init_count + 31) >> 5, sizeof(uint32_t));
+    assertf(map->spawned_mask != NULL, "out of memory");
+    map_activate_spawns(map);
   }
 
+  map_update_actor_grid(map);
+
+  script_verify(map);
+
   if (header->startup_script != INVALID_SCRIPT) {
     assertf(header->startup_script < header->script_count, "invalid startup script %"PRIu32, header->startup_script);
     script_start(map, header->startup_script, NULL);
   }
 
+  // queue the props around the start camera so the first frame has them
+  map_request_props(map);
+
   /*
   if (header->music_id)
     sound_play_music(header->music_id, 0, 0);
@@ -149,6 +241,10 @@ global_state_t map_tick(map_t *map) {
   if (exception_reset_time() > 0)
     return ST_RESET;
 
+#ifdef MAP_BENCH
+  map->bench_mark = get_ticks();
+#endif
+
   if (map->fade_counter) {
     map->fade_counter--;
     if (!map->fade_counter) {
@@ -162,7 +258,8 @@ global_state_t map_tick(map_t *map) {
     }
   }
 
-  pad_t kdown = get_keys_down();
+  pad_t kdown, kpressed;
+  replay_get_keys(&kdown, &kpressed);
 
   if (map->respawn_counter) {
     map->respawn_counter--;
@@ -177,6 +274,7 @@ global_state_t map_tick(map_t *map) {
       if (spawn->flags & AF_CUR_PLAYER) {
         if (player_respawn(map, map->player, spawn)) {
           map->state_flags &= ~(MSF_RESPAWNING|MSF_FORCE_RESPAWN);
+          script_notify(map, SW_STATE);
           break;
         }
       }
@@ -192,8 +290,6 @@ global_state_t map_tick(map_t *map) {
 
   map->frame_counter++;
 
-  pad_t kpressed = get_keys_pressed();
-
   // tick bgs
   for (size_t i = 0; i < map->header->bg_count; i++) {
     bg_header_t *bg = &map->bgs[i];
@@ -225,8 +321,10 @@ global_state_t map_tick(map_t *map) {
     map->quake_counter--;
     if ((map->quake_counter & 4) && map->quake_strength)
       map->quake_strength--;
-    if (map->quake_counter == 0)
+    if (map->quake_counter == 0) {
       map->quake_strength = 0;
+      script_notify(map, SW_EARTHQUAKE);
+    }
   }
   if (map->dialog_text_len) {
     if (map->dialog_counter < (map->dialog_text_len << DIALOG_COUNT_SHIFT)) {
@@ -288,8 +386,10 @@ global_state_t map_tick(map_t *map) {
   if (map->water_line != map->target_water_line) {
     STEPTOWARDS(map->water_line, map->target_water_line, map->water_speed);
     world_move_water(map->world, map->water_line);
-    if (map->water_line == map->target_water_line)
+    if (map->water_line == map->target_water_line) {
       map->state_flags &= ~MSF_WATER_MOVING;
+      script_notify(map, SW_STATE);
+    }
   }
   if (memcmp(&map->target_water_color, &map->water_color, sizeof(color_t)) != 0) {
     STEP1(map->water_color.r, map->target_water_color.r);
@@ -300,13 +400,27 @@ global_state_t map_tick(map_t *map) {
   if (map->hud_crystal_counter)
     map->hud_crystal_counter--;
 
-  // tick scripts
+  map_tick_timers(map);
+
+#ifndef NDEBUG
+  if (kdown.c[0].R)
+    script_profile_dump(map);
+  // let scripts parked for running over budget continue
+  if (kdown.c[0].C_down)
+    script_notify(map, SW_BUDGET);
+#endif
+
+  MAP_BENCH_MARK(MB_MAP);
+
+  // tick scripts, parked scripts are only visited once they are woken up
   {
+    script_wake_timers(map);
     script_state_t *state, *next;
-    TAILQ_FOREACH_SAFE(state, &map->active_scripts, entry, next) {
+    TAILQ_FOREACH_SAFE(state, &map->script_runqueue, sched_entry, next) {
       script_tick(state, map);
     }
   }
+  MAP_BENCH_MARK(MB_SCRIPTS);
 
   // tick camera and player controls
   if (map->cheats & MC_FREE_LOOK) {
@@ -337,8 +451,10 @@ global_state_t map_tick(map_t *map) {
           map->camera_y = ty;
           if (map->camera_waypoint)
             map->camera_waypoint = map->camera_waypoint->next;
-          else if (map->state_flags & MSF_PLAYER_CHANGED)
+          else if (map->state_flags & MSF_PLAYER_CHANGED) {
             map->state_flags &= ~(MSF_PLAYER_CHANGED|MSF_CAMERA_MOVING);
+            script_notify(map, SW_STATE);
+          }
         } else {
           if (map->camera_vel && map->camera_target_vel
               && (!map->camera_waypoint || !map->camera_waypoint->next)) {
@@ -384,29 +500,39 @@ global_state_t map_tick(map_t *map) {
       map->camera_y = bound;
   }
 
+  MAP_BENCH_MARK(MB_CAMERA);
+
+  if (map->spawned_mask)
+    map_activate_spawns(map);
+  MAP_BENCH_MARK(MB_SPAWNS);
+
   sound_set_listener_pos(map->camera_x, map->camera_y);
 
   // tick physics
   world_tick(map->world);
+  MAP_BENCH_MARK(MB_PHYSICS);
 
   // tick actors
   {
-    actor_t *actor;
-    LIST_FOREACH(actor, &map->actors, map) {
+    actor_t *actor, *next;
+    LIST_FOREACH_SAFE(actor, &map->tickers, tick_entry, next) {
       if (actor->ticker)
         actor->ticker(map, actor);
+      else
+        ACTOR_LIST_REMOVE(actor, tick_entry);
     }
   }
 
   // tick sound movement
   {
-    actor_t *actor;
-    // TODO make a separate list for actors playing sounds
-    LIST_FOREACH(actor, &map->actors, map) {
+    actor_t *actor, *next;
+    LIST_FOREACH_SAFE(actor, &map->sounding, sound_entry, next) {
       if (actor->sound_channel != -1) {
         float x, y;
         world_get_actor_center(actor, &x, &y);
         sound_update_position(actor->sound_channel, x, y);
+      } else {
+        ACTOR_LIST_REMOVE(actor, sound_entry);
       }
     }
   }
@@ -428,6 +554,8 @@ global_state_t map_tick(map_t *map) {
     }
   }
 
+  MAP_BENCH_MARK(MB_ACTORS);
+
   // tick particles
   {
     const irect2_t active_rect = {
@@ -463,6 +591,15 @@ global_state_t map_tick(map_t *map) {
     map_foreach_chunk_in_rect(map, &active_rect, map_tick_props);
   }
 
+  MAP_BENCH_MARK(MB_PARTICLES);
+
+  map_request_props(map);
+  cache_service_queue(CACHE_QUEUE_TICKS);
+  MAP_BENCH_MARK(MB_ASSETS);
+
+  map_update_actor_grid(map);
+  MAP_BENCH_MARK(MB_GRID);
+
   return ST_GAME;
 }
 
@@ -495,8 +632,9 @@ void map_transition(map_t *map, surface_t *screen) {
   if (map->player)
     player_save(map->player, &save);
 
-  map_load(maps_paths[map->pending_map], map, map->state_flags);
+  // the startup script needs the id to find its native version
   map->map_id = map->pending_map;
+  map_load(maps_paths[map->pending_map], map, map->state_flags);
 
   if (map->player)
     player_restore(map->player, &save);
@@ -530,27 +668,85 @@ void map_clear_dialog(map_t *map) {
   map->dialog_counter = 0;
   map->dialog_fade_counter = 0;
   map->dialog_target = NULL;
+  script_notify(map, SW_DIALOG);
+}
+
+// ********** TIMERS **********
+
+static bool map_timer_before(const map_timer_t *a, const map_timer_t *b) {
+  int32_t diff = a->deadline - b->deadline;
+  if (diff)
+    return diff < 0;
+  return (int32_t) (a->seq - b->seq) < 0;
+}
+
+static void map_timer_push(map_t *map, map_timer_t timer) {
+  if (map->timer_count == map->timer_capacity) {
+    map->timer_capacity = MAX(map->timer_capacity * 2, 8);
+    map->timers = realloc(map->timers, map->timer_capacity * sizeof(map_timer_t));
+    assertf(map->timers != NULL, "out of memory");
+  }
+  timer.seq = map->timer_seq++;
+  size_t i = map->timer_count++;
+  while (i > 0) {
+    size_t parent = (i - 1) >> 1;
+    if (!map_timer_before(&timer, &map->timers[parent]))
+      break;
+    map->timers[i] = map->timers[parent];
+    i = parent;
+  }
+  map->timers[i] = timer;
+}
+
+static map_timer_t map_timer_pop(map_t *map) {
+  map_timer_t top = map->timers[0];
+  map_timer_t last = map->timers[--map->timer_count];
+  size_t i = 0;
+  while (1) {
+    size_t child = (i << 1) + 1;
+    if (child >= map->timer_count)
+      break;
+    if (child + 1 < map->timer_count && map_timer_before(&map->timers[child + 1], &map->timers[child]))
+      child++;
+    if (!map_timer_before(&map->timers[child], &last))
+      break;
+    map->timers[i] = map->timers[child];
+    i = child;
+  }
+  if (map->timer_count)
+    map->timers[i] = last;
+  return top;
+}
+
+static void map_tick_timers(map_t *map) {
+  while (map->timer_count && (int32_t) (map->frame_counter - map->timers[0].deadline) >= 0) {
+    map_timer_t timer = map_timer_pop(map);
+    script_ret_t ret = timer.func(map, NULL);
+    if (timer.period && ret != RET_EXIT) {
+      timer.deadline += timer.period;
+      map_timer_push(map, timer);
+    }
+  }
 }
 
 void map_call_delay(map_t *map, script_exec_t func, uint32_t frames) {
-  script_builder_t builder;
-  script_builder_init(&builder);
-  if (frames)
-    script_builder_push_delay(&builder, frames);
-  script_builder_push_exec(&builder, func);
-  dynscript_t *script = script_builder_finish_exit(&builder, map);
-  script_start_dynamic(map, script, NULL);
-  script_unref(script);
+  if (frames == 0) {
+    func(map, NULL);
+    return;
+  }
+  map_timer_push(map, (map_timer_t) {
+    .deadline = map->frame_counter + frames,
+    .func = func,
+  });
 }
 
 void map_call_interval(map_t *map, script_exec_t func, uint32_t frames) {
-  script_builder_t builder;
-  script_builder_init(&builder);
-  script_t *loop = script_builder_push_delay(&builder, frames);
-  script_builder_push_exec(&builder, func);
-  dynscript_t *script = script_builder_finish_jump_dynamic(&builder, map, loop);
-  script_start_dynamic(map, script, NULL);
-  script_unref(script);
+  assertf(frames > 0, "interval must be at least one frame");
+  map_timer_push(map, (map_timer_t) {
+    .deadline = map->frame_counter + frames,
+    .period = frames,
+    .func = func,
+  });
 }
 
 tile_chunk_t *map_get_chunk(map_t *map, int32_t x, int32_t y) {
@@ -593,10 +789,65 @@ void map_foreach_chunk_in_rect_expand(map_t *map, const irect2_t *rect, int32_t
   }
 }
 
+static void map_spawn_chunk_actors(map_t *map, const irect2_t *rect, tile_chunk_t *chunk) {
+  if (chunk->spawns_active)
+    return;
+  chunk->spawns_active = true;
+  for (size_t i = chunk->spawn_count; i > 0; i--) {
+    uint16_t index = chunk->spawns[i - 1];
+    uint32_t bit = 1 << (index & 31);
+    // large triggers can be listed in more than one chunk
+    if (map->spawned_mask[index >> 5] & bit)
+      continue;
+    map->spawned_mask[index >> 5] |= bit;
+    actor_spawn(map, &map->header->actor_spawns[index]);
+  }
+}
+
+static void map_activate_spawns(map_t *map) {
+  const irect2_t rect = {
+    .x0 = map->camera_x - screen_half_width,
+    .y0 = map->camera_y - screen_half_height,
+    .x1 = map->camera_x + screen_half_width,
+    .y1 = map->camera_y + screen_half_height,
+  };
+  map_foreach_chunk_in_rect_expand(map, &rect, SPAWN_CLIP_EXTEND, map_spawn_chunk_actors);
+}
+
+// props take refs on whatever of theirs is resident once they come near the
+// camera and queue the rest, render skips them until both are in
+static void map_request_chunk_props(map_t *map, const irect2_t *rect, tile_chunk_t *chunk) {
+  prop_t **props = chunk->props;
+  size_t prop_count = chunk->prop_count;
+  for (size_t i = 0; i < prop_count; i++) {
+    prop_t *prop = props[i];
+    if (prop->frame_wanted == map->frame_counter || !prop_in_rect(prop, rect))
+      continue;
+    prop->frame_wanted = map->frame_counter;
+    bool active = prop->anim.image || prop->anim.tiles;
+    if (!prop->anim.image)
+      prop->anim.image = sprite_pool_try_load(prop->image_id);
+    if (!prop->anim.tiles && prop->tiles_id)
+      prop->anim.tiles = tileset_pool_try_load(prop->tiles_id);
+    if (!active && (prop->anim.image || prop->anim.tiles))
+      STAILQ_INSERT_TAIL(&map->active_props, prop, active);
+  }
+}
+
+void map_request_props(map_t *map) {
+  const irect2_t rect = {
+    .x0 = map->camera_x - screen_half_width - PROP_LOOKAHEAD_EXTEND,
+    .y0 = map->camera_y - screen_half_height - PROP_LOOKAHEAD_EXTEND,
+    .x1 = map->camera_x + screen_half_width + PROP_LOOKAHEAD_EXTEND,
+    .y1 = map->camera_y + screen_half_height + PROP_LOOKAHEAD_EXTEND,
+  };
+  map_foreach_chunk_in_rect(map, &rect, map_request_chunk_props);
+}
+
 void map_unload_props(map_t *map, bool all) {
   prop_t *prop, *next, *prev = NULL;
   STAILQ_FOREACH_SAFE(prop, &map->active_props, active, next) {
-    if (all || map->frame_counter - PROP_UNLOAD_FRAMES > prop->frame_drawn) {
+    if (all || (int32_t) (map->frame_counter - prop->frame_wanted) > PROP_UNLOAD_FRAMES) {
       if (prop->anim.tiles) {
         tileset_pool_unload(prop->anim.tiles);
         prop->anim.tiles = NULL;
@@ -622,6 +873,68 @@ void map_unload_props(map_t *map, bool all) {
   }
 }
 
+// ********** ACTOR GRID **********
+
+// actors outside the map are clamped to the edge cells
+static uint32_t map_actor_grid_cell(map_t *map, int32_t x, int32_t y) {
+  x = CLAMP((x >> CHUNK_PIXEL_SHIFT) - map->lower_x, 0, map->width - 1);
+  y = CLAMP((y >> CHUNK_PIXEL_SHIFT) - map->lower_y, 0, map->height - 1);
+  return y * map->width + x;
+}
+
+// each drawable sits in the single cell of its top left corner, so it is only
+// ever visited once. queries widen their lower edge by the biggest actor in
+// the grid, which is recomputed every update so it shrinks again
+void map_update_actor_grid(map_t *map) {
+  actor_t *actor;
+  int32_t max_width = 0, max_height = 0;
+  LIST_FOREACH(actor, &map->drawables, draw_entry) {
+    irect2_t *bounds = &actor->bounds;
+    if (!actor->body || !world_get_actor_bounds(actor, bounds)) {
+      if (ACTOR_LIST_LINKED(actor, grid_entry))
+        ACTOR_LIST_REMOVE(actor, grid_entry);
+      continue;
+    }
+    max_width = MAX(max_width, bounds->x1 - bounds->x0);
+    max_height = MAX(max_height, bounds->y1 - bounds->y0);
+    uint32_t cell = map_actor_grid_cell(map, bounds->x0, bounds->y0);
+    if (ACTOR_LIST_LINKED(actor, grid_entry)) {
+      if (actor->grid_cell == cell)
+        continue;
+      LIST_REMOVE(actor, grid_entry);
+    }
+    actor->grid_cell = cell;
+    LIST_INSERT_HEAD(&map->actor_grid[cell], actor, grid_entry);
+  }
+  map->actor_grid_max_width = max_width;
+  map->actor_grid_max_height = max_height;
+}
+
+void map_foreach_actor_in_rect(map_t *map, const irect2_t *rect, int32_t expand, world_actor_func_t func, void *arg) {
+  irect2_t area = {
+    .x0 = rect->x0 - expand,
+    .y0 = rect->y0 - expand,
+    .x1 = rect->x1 + expand,
+    .y1 = rect->y1 + expand,
+  };
+  uint32_t first = map_actor_grid_cell(map, area.x0 - map->actor_grid_max_width, area.y0 - map->actor_grid_max_height);
+  uint32_t last = map_actor_grid_cell(map, area.x1, area.y1);
+  uint32_t cx0 = first % map->width;
+  uint32_t cx1 = last % map->width;
+  for (uint32_t row = first - cx0; row <= last - cx1; row += map->width) {
+    for (uint32_t cell = row + cx0; cell <= row + cx1; cell++) {
+      actor_t *actor;
+      LIST_FOREACH(actor, &map->actor_grid[cell], grid_entry) {
+        const irect2_t *bounds = &actor->bounds;
+        if (bounds->x0 > area.x1 || bounds->x1 < area.x0 || bounds->y0 > area.y1 || bounds->y1 < area.y0)
+          continue;
+        if (!func(actor, rect, arg))
+          return;
+      }
+    }
+  }
+}
+
 // ********** MAP UNLOAD **********
 
 void map_unload(map_t *map) {
@@ -654,7 +967,25 @@ void map_unload(map_t *map) {
   }
   if (map->chunks)
     free(map->chunks);
+  if (map->actor_grid)
+    free(map->actor_grid);
+  if (map->spawned_mask)
+    free(map->spawned_mask);
+  if (map->script_instances)
+    free(map->script_instances);
+  if (map->script_profiles)
+    free(map->script_profiles);
+  if (map->timers)
+    free(map->timers);
   world_destroy(map->world);
+#ifndef NDEBUG
+  cache_stats_t stats;
+  cache_get_stats(&stats);
+  debugf("asset cache: %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " evictions, %" PRIu32 "K resident"
+      " (%" PRIu32 "K in %" PRIu32 " retained) of %" PRIu32 "K\n",
+      stats.hits, stats.misses, stats.evictions, stats.resident_bytes >> 10,
+      stats.retained_bytes >> 10, stats.retained_count, stats.budget >> 10);
+#endif
   free(map->header);
   memset(map, 0, sizeof(map_t));
 }
@@ -726,6 +1057,20 @@ void particle_spawn(map_t *map, float cx, float cy, const particle_spawn_t *spaw
   }
 }
 
+bool prop_in_rect(prop_t *prop, const irect2_t *rect) {
+  int32_t x0 = prop->x;
+  if (x0 >= rect->x1)
+    return false;
+  if (x0 + prop->width < rect->x0)
+    return false;
+  int32_t y0 = prop->y;
+  if (y0 >= rect->y1)
+    return false;
+  if (y0 + prop->height < rect->y0)
+    return false;
+  return true;
+}
+
 bool particle_in_rect(particle_t *particle, const irect2_t *rect) {
   tiles_desc_t *tiles = particle->anim.tiles;
 
@@ -3,6 +3,7 @@
 #include <libdragon.h>
 #include <sys/queue.h>
 
+#include "cache.h"
 #include "main.h"
 #include "script.h"
 #include "util.h"
@@ -39,6 +40,8 @@ typedef struct controller_data pad_t;
 #define INVALID_WAYPOINT 0xffffffff
 
 #define ACTIVE_CLIP_EXTEND 128
+#define SPAWN_CLIP_EXTEND CHUNK_PIXEL_DIM
+#define PROP_LOOKAHEAD_EXTEND CHUNK_PIXEL_DIM
 
 #define DIALOG_FADE_LEN 20
 #define DIALOG_MAX_LINES 3
@@ -156,6 +159,13 @@ typedef enum {
   PARTICLE_LOOPED     = 1<<7,
 } particle_flags_t;
 
+typedef struct {
+  uint32_t deadline; // frame_counter value to fire on
+  uint32_t period; // 0 for one-shot timers
+  uint32_t seq;
+  script_exec_t func;
+} map_timer_t;
+
 typedef struct waypoint_s {
   int32_t x;
   int32_t y;
@@ -175,6 +185,7 @@ typedef struct prop_s {
   uint32_t tiles_id;
   uint32_t frame_drawn;
   uint32_t frame_ticked;
+  uint32_t frame_wanted; // last frame_counter it was inside the look-ahead rect
   sprite_anim_t anim;
   STAILQ_ENTRY(prop_s) active;
 } prop_t;
@@ -191,6 +202,12 @@ typedef struct tile_chunk_s {
     prop_t **props;
     uint32_t prop_offset;
   };
+  union {
+    uint16_t *spawns; // indices into actor_spawns
+    uint32_t spawn_offset;
+  };
+  uint16_t spawn_count;
+  bool spawns_active;
   body_t *body;
   //uint16_t[16] lightmask
   uint16_t tiles[];
@@ -210,6 +227,9 @@ typedef struct {
   uint16_t text_count;
   uint16_t actor_spawn_init_count;
   uint16_t actor_spawn_count;
+  uint16_t actor_spawn_eager_count;
+  uint8_t velocity_iterations;
+  uint8_t position_iterations;
   union {
     actor_spawn_t *actor_spawns;
     uint32_t actor_spawns_offset;
@@ -240,6 +260,10 @@ typedef struct {
   color_t water_color;
   float gravity_x;
   float gravity_y;
+  union {
+    asset_ref_t *manifest; // ends at AK_NONE
+    uint32_t manifest_offset;
+  };
 } map_header_t;
 
 typedef enum {
@@ -254,6 +278,21 @@ typedef enum {
   FADE_CROSS_WIPE,
 } map_fade_t;
 
+#ifdef MAP_BENCH
+typedef enum {
+  MB_MAP,
+  MB_SCRIPTS,
+  MB_CAMERA,
+  MB_SPAWNS,
+  MB_PHYSICS,
+  MB_ACTORS,
+  MB_PARTICLES,
+  MB_ASSETS,
+  MB_GRID,
+  MB_COUNT,
+} map_bench_section_t;
+#endif
+
 struct map_s {
   map_header_t *header;
   world_t *world;
@@ -269,6 +308,13 @@ struct map_s {
   tile_chunk_t **chunks;
   LIST_HEAD(, actor_s) actors;
   LIST_HEAD(, actor_s) dead;
+  LIST_HEAD(, actor_s) tickers;
+  LIST_HEAD(, actor_s) drawables;
+  LIST_HEAD(actor_cell_s, actor_s) *actor_grid; // drawables bucketed per chunk by bounds corner
+  int32_t actor_grid_max_width;
+  int32_t actor_grid_max_height;
+  LIST_HEAD(, actor_s) sounding;
+  uint32_t *spawned_mask;
   actor_t *player;
   actor_t *hudplayer;
 
@@ -301,6 +347,11 @@ struct map_s {
 
   STAILQ_HEAD(, prop_s) active_props;
   TAILQ_HEAD(, script_state_s) active_scripts;
+  script_queue_t script_runqueue;
+  script_queue_t script_waitqueues[SW_COUNT];
+  script_queue_t script_timers[SCRIPT_TIMER_SLOTS];
+  script_queue_t *script_instances; // running states per map script id
+  script_profile_t *script_profiles;
 
   const char *dialog_text;
   size_t dialog_text_len;
@@ -324,6 +375,16 @@ struct map_s {
 
   LIST_HEAD(, particle_s) particles;
 
+  map_timer_t *timers; // min-heap on deadline
+
+#ifdef MAP_BENCH
+  uint64_t bench_ticks[MB_COUNT];
+  uint32_t bench_mark;
+#endif
+  size_t timer_count;
+  size_t timer_capacity;
+  uint32_t timer_seq;
+
   tileset_header_t *tid_map[(MAX_TID+1)>>TID_MAP_SHIFT];
 };
 
@@ -339,6 +400,7 @@ typedef enum {
 
 typedef enum {
   MC_DEBUG_DRAW = 1 << 0,
+  MC_PHYSICS_PROFILE = 1 << 1,
   MC_FREE_LOOK  = 1 << 4,
 } map_cheats_t;
 
@@ -352,6 +414,7 @@ void map_transition(map_t *map, surface_t *screen);
 void map_set_dialog(map_t *map, const char *text, actor_t *target);
 void map_clear_dialog(map_t *map);
 
+// timer callbacks get a NULL script state, returning RET_EXIT stops an interval
 void map_call_delay(map_t *map, script_exec_t func, uint32_t frames);
 void map_call_interval(map_t *map, script_exec_t func, uint32_t frames);
 
@@ -365,7 +428,11 @@ inline void *map_get_pointer(map_t *map, uintptr_t ptr) {
 tile_chunk_t *map_get_chunk(map_t *map, int32_t x, int32_t y);
 void map_foreach_chunk_in_rect(map_t *map, const irect2_t *rect, chunk_iter_t func);
 void map_foreach_chunk_in_rect_expand(map_t *map, const irect2_t *rect, int32_t expand, chunk_iter_t func);
+void map_request_props(map_t *map);
 void map_unload_props(map_t *map, bool all);
+bool prop_in_rect(prop_t *prop, const irect2_t *rect);
+void map_update_actor_grid(map_t *map);
+void map_foreach_actor_in_rect(map_t *map, const irect2_t *rect, int32_t expand, world_actor_func_t func, void *arg);
 
 bool sprite_anim_tick(sprite_anim_t *anim);
 void sprite_anim_cleanup(sprite_anim_t *anim);
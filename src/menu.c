@@ -1,5 +1,6 @@
 #include "menu.h"
 #include "assets.h"
+#include "cache.h"
 #include "main.h"
 #include "map.h"
 #include "render.h"
@@ -7,6 +8,8 @@
 #include "util.h"
 
 #include <libdragon.h>
+#include <inttypes.h>
+#include <string.h>
 
 #define GAME_URL "https://9nova.itch.io/aliensun"
 
@@ -16,6 +19,10 @@
 #define ROW_SPACING 16
 #define COL_SPACING 18
 
+#define CACHE_LIST_MAX 256
+#define CACHE_LIST_ROWS 14
+#define CACHE_ROW_SPACING 10
+
 #define FOREACH_MENU_ACTION \
   ENTRY(SPACER, NULL) \
   ENTRY(START, "Start") \
@@ -26,6 +33,7 @@
   ENTRY(ASPECT, "Screen Aspect") \
   ENTRY(SFX_VOL, "SFX Volume") \
   ENTRY(MUS_VOL, "Music Volume") \
+  ENTRY(CACHE, "Asset Cache") \
   ENTRY(BACK, "Back")
 
 typedef enum {
@@ -47,13 +55,22 @@ static int menu_move(int pos, pad_t *kdown, size_t len);
 static int8_t get_x_push(struct SI_condat *con);
 
 static int options_menu_tick(int pos, map_t *map, surface_t **screen);
+#ifndef NDEBUG
+static void cache_screen_open(void);
+static int cache_screen_tick(int pos);
+static void render_cache_screen(int pos);
+#endif
 
 static void render_center_menu(int32_t y, int pos, const menu_action_t *menu, size_t len);
 static void render_options_menu(int32_t x_divider, int32_t y, int pos, const menu_action_t *menu, size_t len);
 static void render_main_options_menu(int pos);
 
 static const menu_action_t main_menu[] = { MA_START, MA_OPTIONS };
+#ifndef NDEBUG
+static const menu_action_t pause_menu[] = { MA_RESUME, MA_OPTIONS, MA_RESPAWN, MA_CACHE, MA_QUIT };
+#else
 static const menu_action_t pause_menu[] = { MA_RESUME, MA_OPTIONS, MA_RESPAWN, MA_QUIT };
+#endif
 static const menu_action_t options_menu[] = { MA_ASPECT, MA_SFX_VOL, MA_MUS_VOL };
 static const menu_action_t back_menu[] = { MA_BACK };
 
@@ -62,6 +79,11 @@ static int8_t joystick_y_direction = 0;
 
 static int menu_sound_channel = -1;
 
+#ifndef NDEBUG
+static cache_entry_info_t cache_entries[CACHE_LIST_MAX];
+static size_t cache_entry_count;
+#endif
+
 global_state_t main_menu_loop(map_t *map) {
   global_state_t state = ST_GAME;
   unsigned long start = get_ticks();
@@ -138,6 +160,9 @@ global_state_t pause_loop(map_t *map) {
   global_state_t state;
   int pos = 0;
   int options_pos = -1;
+#ifndef NDEBUG
+  int cache_pos = -1;
+#endif
 
   sound_set_music_gain(0.5);
   sound_pause_fx();
@@ -148,6 +173,10 @@ global_state_t pause_loop(map_t *map) {
 
     if (options_pos >= 0) {
       options_pos = options_menu_tick(options_pos, map, NULL);
+#ifndef NDEBUG
+    } else if (cache_pos >= 0) {
+      cache_pos = cache_screen_tick(cache_pos);
+#endif
     } else if (pos >= 0) {
       controller_scan();
       pad_t kdown = get_keys_down_stick_to_pad();
@@ -161,6 +190,9 @@ global_state_t pause_loop(map_t *map) {
         case MA_RESUME: state = ST_GAME; goto done; break;
         case MA_OPTIONS: options_pos = 0; break;
         case MA_RESPAWN: state = ST_GAME; map->state_flags |= MSF_FORCE_RESPAWN; goto done; break;
+#ifndef NDEBUG
+        case MA_CACHE: cache_screen_open(); cache_pos = 0; break;
+#endif
         case MA_QUIT: state = ST_MAIN_MENU; goto done; break;
         default: break;
         }
@@ -184,6 +216,10 @@ global_state_t pause_loop(map_t *map) {
     rdpq_fill_rectangle(0, 0, display_get_width(), display_get_height());
     if (options_pos >= 0) {
       render_main_options_menu(options_pos);
+#ifndef NDEBUG
+    } else if (cache_pos >= 0) {
+      render_cache_screen(cache_pos);
+#endif
     } else {
       rdpq_text_print(&(rdpq_textparms_t){ .align = ALIGN_CENTER, .width = display_get_width() },
                       FONT_MED, 0, screen_half_height - 6, "Pause");
@@ -248,6 +284,74 @@ static int options_menu_tick(int pos, map_t *map, surface_t **screen) {
   return pos;
 }
 
+#ifndef NDEBUG
+static int cache_entry_compare(const void *va, const void *vb) {
+  uint32_t a = ((const cache_entry_info_t *) va)->size;
+  uint32_t b = ((const cache_entry_info_t *) vb)->size;
+  return a < b ? 1 : a > b ? -1 : 0;
+}
+
+// the list is taken once when the screen opens, nothing loads while paused
+static void cache_screen_open(void) {
+  cache_entry_count = cache_list_resident(cache_entries, CACHE_LIST_MAX);
+  qsort(cache_entries, cache_entry_count, sizeof(cache_entry_info_t), cache_entry_compare);
+}
+
+static int cache_screen_tick(int pos) {
+  controller_scan();
+  pad_t kdown = get_keys_down_stick_to_pad();
+  if (kdown.c[0].B || kdown.c[0].start) {
+    sound_play_fx_global(SFX_BLIP, 0, &menu_sound_channel);
+    return -1;
+  }
+  int last = MAX((int) cache_entry_count - CACHE_LIST_ROWS, 0);
+  if (kdown.c[0].up)
+    pos--;
+  if (kdown.c[0].down)
+    pos++;
+  if (kdown.c[0].left)
+    pos -= CACHE_LIST_ROWS;
+  if (kdown.c[0].right)
+    pos += CACHE_LIST_ROWS;
+  return CLAMP(pos, 0, last);
+}
+
+static void render_cache_screen(int pos) {
+  static const uint8_t kinds[] = { AK_GFX, AK_TILESET, AK_MODEL };
+  static const char * const kind_names[] = {
+    [AK_GFX] = "gfx", [AK_TILESET] = "tiles", [AK_MODEL] = "model",
+  };
+  int32_t x = 16;
+  int32_t y = 16;
+  cache_stats_t stats;
+  cache_get_stats(&stats);
+  rdpq_text_printf(NULL, FONT_SMALL, x, y,
+      "resident %"PRIu32"K of %"PRIu32"K, retained %"PRIu32"K in %"PRIu32", evicted %"PRIu32,
+      stats.resident_bytes >> 10, stats.budget >> 10, stats.retained_bytes >> 10,
+      stats.retained_count, stats.evictions);
+  y += CACHE_ROW_SPACING;
+  FOREACH_ARRAY(kind, kinds) {
+    cache_pool_stats_t pool;
+    cache_get_pool_stats(*kind, &pool);
+    rdpq_text_printf(NULL, FONT_SMALL, x, y,
+        "%s: %"PRIu32" files %"PRIu32"K, %"PRIu32" refs, %"PRIu32" hits, %"PRIu32" misses, %"PRIu32"ms loading",
+        kind_names[*kind], pool.entries, pool.bytes >> 10, pool.refs, pool.hits, pool.misses,
+        (uint32_t) (pool.load_ticks / TICKS_FROM_MS(1)));
+    y += CACHE_ROW_SPACING;
+  }
+  y += CACHE_ROW_SPACING;
+  for (size_t i = pos; i < cache_entry_count && i < pos + CACHE_LIST_ROWS; i++) {
+    const cache_entry_info_t *entry = &cache_entries[i];
+    const char *path = cache_asset_path(entry->kind, entry->id);
+    if (!strncmp(path, "rom:/", 5))
+      path += 5;
+    rdpq_text_printf(NULL, FONT_SMALL, x, y, "%5"PRIu32"K %2"PRIu32"%c %s",
+        (entry->size + 1023) >> 10, entry->refcount, entry->pinned ? '*' : ' ', path);
+    y += CACHE_ROW_SPACING;
+  }
+}
+#endif
+
 static int8_t get_x_push(struct SI_condat *con) {
   int8_t push = 0;
   if (con->left)
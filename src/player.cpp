@@ -142,6 +142,9 @@ void player_movement(map_t *map, actor_t *actor, const pad_t *kdown, const pad_t
   if (kdown->c[0].L) {
     map->cheats ^= MC_DEBUG_DRAW;
   }
+  if (kdown->c[0].C_up) {
+    map->cheats ^= MC_PHYSICS_PROFILE;
+  }
 #endif
   if (actor->type == AT_YELLOW)
     yellow_movement(map, actor, kdown, kpressed);
@@ -30,7 +30,6 @@
 typedef struct {
   actor_t *actors[MAX_VIS_ACTORS];
   size_t count;
-  int32_t frame_id;
 } actor_visarray_t;
 
 static bool frame_used_gl;
@@ -64,8 +63,9 @@ void render_scene(map_t *map) {
     .y1 = map->camera_y + screen_half_height,
   };
   if (map->quake_counter) {
-    int32_t qx = RANDN(&map->rng, map->quake_strength << 1) - (int32_t) map->quake_strength;
-    int32_t qy = RANDN(&map->rng, map->quake_strength << 1) - (int32_t) map->quake_strength;
+    // render_rng, the number of frames drawn depends on lag
+    int32_t qx = RANDN(&map->render_rng, map->quake_strength << 1) - (int32_t) map->quake_strength;
+    int32_t qy = RANDN(&map->render_rng, map->quake_strength << 1) - (int32_t) map->quake_strength;
     rect.x0 += qx;
     rect.x1 += qx;
     rect.y0 += qy;
@@ -85,8 +85,7 @@ void render_scene(map_t *map) {
   {
     actor_visarray_t vis;
     vis.count = 0;
-    vis.frame_id = map->render_counter;
-    world_foreach_actor_in_rect(map->world, &rect, ACTIVE_CLIP_EXTEND, render_queue_actor, &vis);
+    map_foreach_actor_in_rect(map, &rect, ACTIVE_CLIP_EXTEND, render_queue_actor, &vis);
     qsort(vis.actors, vis.count, sizeof(actor_t *), actor_vis_sort);
     for (size_t i = 0; i < vis.count; i++) {
       actor_t *actor = vis.actors[i];
@@ -154,6 +153,17 @@ void render_scene(map_t *map) {
 #ifndef NDEBUG
   if (map->cheats & MC_DEBUG_DRAW)
     world_debug_draw(map->world);
+  if (map->cheats & MC_PHYSICS_PROFILE) {
+    world_profile_t profile;
+    int y = display_get_height() - 44;
+    world_get_profile(map->world, &profile);
+    render_shadow_printf(NULL, FONT_SMALL, 16, y, "STEP %.2f  COLLIDE %.2f  SOLVE %.2f",
+        profile.step_ms, profile.collide_ms, profile.solve_ms);
+    render_shadow_printf(NULL, FONT_SMALL, 16, y + 10, "TOI %.2f  BROADPHASE %.2f  ITER %u/%u",
+        profile.solve_toi_ms, profile.broadphase_ms, profile.velocity_iterations, profile.position_iterations);
+    render_shadow_printf(NULL, FONT_SMALL, 16, y + 20, "BODIES %u/%u  CONTACTS %u  MEM %luK",
+        profile.awake_bodies, profile.bodies, profile.contacts, (unsigned long) (profile.alloc.bytes >> 10));
+  }
 #endif
 
   if (map->hudplayer && map->hudplayer->type == AT_YELLOW && (map->state_flags & MSF_PLAYER_CONTROL)) {
@@ -179,16 +189,9 @@ void render_scene(map_t *map) {
 }
 
 static bool render_queue_actor(actor_t *actor, const irect2_t *rect, void *arg) {
-  if (actor->drawer) {
-    actor_visarray_t *array = arg;
-    if (actor->frame_drawn != array->frame_id) {
-      array->actors[array->count++] = actor;
-      actor->frame_drawn = array->frame_id;
-      if (array->count >= MAX_VIS_ACTORS)
-        return false;
-    }
-  }
-  return true;
+  actor_visarray_t *array = arg;
+  array->actors[array->count++] = actor;
+  return array->count < MAX_VIS_ACTORS;
 }
 
 static int actor_vis_sort(const void *va, const void *vb) {
@@ -296,30 +299,15 @@ static void render_bgs(map_t *map, const irect2_t *rect, uint8_t layer) {
   }
 }
 
-static bool prop_in_rect(prop_t *prop, const irect2_t *rect) {
-  int32_t x0 = prop->x;
-  if (x0 >= rect->x1)
-    return false;
-  if (x0 + prop->width < rect->x0)
-    return false;
-  int32_t y0 = prop->y;
-  if (y0 >= rect->y1)
-    return false;
-  if (y0 + prop->height < rect->y0)
-    return false;
-  return true;
-}
-
 static void render_props(map_t *map, const irect2_t *rect, tile_chunk_t *chunk, uint8_t layer) {
   prop_t **props = chunk->props;
   size_t prop_count = chunk->prop_count;
   for (size_t i = 0; i < prop_count; i++) {
     prop_t *prop = props[i];
     if (prop->layer == layer && prop->frame_drawn != map->render_counter && prop_in_rect(prop, rect)) {
-      if (!prop->anim.image)
-        prop->anim.image = sprite_pool_load(prop->image_id);
-      if (!prop->anim.tiles && prop->tiles_id)
-        prop->anim.tiles = tileset_pool_load(prop->tiles_id);
+      // map_request_props hasn't got everything resident yet
+      if (!prop->anim.image || (prop->tiles_id && !prop->anim.tiles))
+        continue;
       rdpq_blitparms_t parms = {};
       tiles_desc_t *tiles = prop->anim.tiles;
       if (tiles) {
@@ -0,0 +1,172 @@
+#include <libdragon.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "replay.h"
+#include "assets.h"
+#include "main.h"
+#include "map.h"
+
+#ifdef REPLAY
+
+#define REPLAY_MAGIC 0x52504c31 // RPL1
+#define REPLAY_FLUSH_FRAMES (FPS * 2)
+#define REPLAY_HIST_BUCKETS 48 // 1ms each, the last one takes the rest
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seed;
+} replay_header_t;
+
+typedef struct {
+  struct SI_condat down;
+  struct SI_condat pressed;
+} replay_frame_t;
+
+static FILE *replay_file;
+static uint32_t replay_seed_value = REPLAY_SEED;
+static uint32_t replay_frames;
+
+#ifdef REPLAY_PLAY
+typedef struct {
+  uint32_t frames;
+  uint64_t ticks;
+  uint32_t max_ticks;
+  uint32_t buckets[REPLAY_HIST_BUCKETS];
+} replay_histogram_t;
+
+static replay_histogram_t replay_histograms[NUM_MAPS];
+static uint32_t replay_frame_start;
+static uint32_t replay_frame_ticks;
+static bool replay_frame_active;
+
+static void replay_dump_histograms(void);
+#endif
+
+void replay_init(void) {
+  replay_header_t header;
+#ifdef REPLAY_RECORD
+  debug_init_sdfs("sd:/", -1);
+  replay_file = fopen("sd:/replay.rpl", "wb");
+  assertf(replay_file != NULL, "failed to open sd:/replay.rpl");
+  header.magic = REPLAY_MAGIC;
+  header.seed = replay_seed_value;
+  fwrite(&header, sizeof header, 1, replay_file);
+  fflush(replay_file);
+  debugf("replay: recording with seed %08" PRIx32 "\n", replay_seed_value);
+#else
+  replay_file = fopen("rom:/replay.rpl", "rb");
+  assertf(replay_file != NULL, "failed to open rom:/replay.rpl");
+  size_t read = fread(&header, sizeof header, 1, replay_file);
+  assertf(read == 1 && header.magic == REPLAY_MAGIC, "rom:/replay.rpl is not a replay");
+  replay_seed_value = header.seed;
+  debugf("replay: playing with seed %08" PRIx32 "\n", replay_seed_value);
+#endif
+}
+
+uint32_t replay_seed(void) {
+  return replay_seed_value;
+}
+
+// start is masked out as the pause menu isn't part of the log. once a replay
+// runs out the pads are live again
+void replay_get_keys(pad_t *kdown, pad_t *kpressed) {
+  *kdown = get_keys_down();
+  *kpressed = get_keys_pressed();
+  if (!replay_file)
+    return;
+  replay_frame_t frame;
+#ifdef REPLAY_RECORD
+  kdown->c[0].start = 0;
+  kpressed->c[0].start = 0;
+  frame.down = kdown->c[0];
+  frame.pressed = kpressed->c[0];
+  fwrite(&frame, sizeof frame, 1, replay_file);
+  if (++replay_frames % REPLAY_FLUSH_FRAMES == 0)
+    fflush(replay_file);
+#else
+  if (fread(&frame, sizeof frame, 1, replay_file) != 1) {
+    debugf("replay: finished after %" PRIu32 " frames\n", replay_frames);
+    fclose(replay_file);
+    replay_file = NULL;
+    replay_dump_histograms();
+    return;
+  }
+  replay_frames++;
+  kdown->c[0] = frame.down;
+  kpressed->c[0] = frame.pressed;
+#endif
+}
+
+#ifdef REPLAY_PLAY
+void replay_frame_begin(void) {
+  replay_frame_active = replay_file != NULL;
+  replay_frame_ticks = 0;
+  replay_frame_start = get_ticks();
+}
+
+void replay_frame_pause(void) {
+  replay_frame_ticks += get_ticks() - replay_frame_start;
+}
+
+void replay_frame_resume(void) {
+  replay_frame_start = get_ticks();
+}
+
+void replay_frame_end(map_t *map) {
+  if (!replay_frame_active)
+    return;
+  replay_frame_active = false;
+  replay_frame_ticks += get_ticks() - replay_frame_start;
+  if (map->map_id >= NUM_MAPS)
+    return;
+  replay_histogram_t *hist = &replay_histograms[map->map_id];
+  uint32_t bucket = TICKS_TO_MS(replay_frame_ticks);
+  hist->buckets[MIN(bucket, REPLAY_HIST_BUCKETS - 1)]++;
+  hist->ticks += replay_frame_ticks;
+  hist->max_ticks = MAX(hist->max_ticks, replay_frame_ticks);
+  hist->frames++;
+}
+
+static uint32_t replay_histogram_percentile(const replay_histogram_t *hist, uint32_t percent) {
+  uint32_t target = (hist->frames * percent + 99) / 100;
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < REPLAY_HIST_BUCKETS; i++) {
+    count += hist->buckets[i];
+    if (count >= target)
+      return i;
+  }
+  return REPLAY_HIST_BUCKETS - 1;
+}
+
+static void replay_dump_histograms(void) {
+  for (size_t i = 0; i < NUM_MAPS; i++) {
+    const replay_histogram_t *hist = &replay_histograms[i];
+    if (!hist->frames)
+      continue;
+    debugf("replay: %s %" PRIu32 " frames, mean %.2fms, p50 %" PRIu32 "ms, p95 %" PRIu32 "ms, p99 %" PRIu32 "ms, max %.2fms\n",
+        maps_paths[i], hist->frames,
+        (double) hist->ticks * (1000.0 / TICKS_PER_SECOND) / hist->frames,
+        replay_histogram_percentile(hist, 50), replay_histogram_percentile(hist, 95),
+        replay_histogram_percentile(hist, 99), hist->max_ticks * (1000.0 / TICKS_PER_SECOND));
+    for (uint32_t b = 0; b < REPLAY_HIST_BUCKETS; b++) {
+      if (hist->buckets[b])
+        debugf("  %2" PRIu32 "%s ms %" PRIu32 "\n", b, b == REPLAY_HIST_BUCKETS - 1 ? "+" : " ", hist->buckets[b]);
+    }
+  }
+}
+#endif
+
+#else
+
+extern inline void replay_get_keys(pad_t *kdown, pad_t *kpressed);
+
+#endif
+
+#ifndef REPLAY_PLAY
+extern inline void replay_frame_begin(void);
+extern inline void replay_frame_pause(void);
+extern inline void replay_frame_resume(void);
+extern inline void replay_frame_end(map_t *map);
+#endif
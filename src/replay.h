@@ -0,0 +1,49 @@
+#pragma once
+
+#include <libdragon.h>
+#include <stdint.h>
+
+#include "map.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// REPLAY_RECORD logs the pads map_tick sees to sd:/replay.rpl, REPLAY_PLAY
+// feeds rom:/replay.rpl back in and times every frame. both seed the map rngs
+// with a fixed value so the same inputs give the same game
+#if defined(REPLAY_RECORD) || defined(REPLAY_PLAY)
+#define REPLAY
+#endif
+
+#ifndef REPLAY_SEED
+#define REPLAY_SEED 0x616c6e73
+#endif
+
+#ifdef REPLAY
+void replay_init(void);
+uint32_t replay_seed(void);
+void replay_get_keys(pad_t *kdown, pad_t *kpressed);
+#else
+inline void replay_get_keys(pad_t *kdown, pad_t *kpressed) {
+  *kdown = get_keys_down();
+  *kpressed = get_keys_pressed();
+}
+#endif
+
+#ifdef REPLAY_PLAY
+// the throttle wait is paused out so only the game's own work is counted
+void replay_frame_begin(void);
+void replay_frame_pause(void);
+void replay_frame_resume(void);
+void replay_frame_end(map_t *map);
+#else
+inline void replay_frame_begin(void) {}
+inline void replay_frame_pause(void) {}
+inline void replay_frame_resume(void) {}
+inline void replay_frame_end(map_t *map) {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
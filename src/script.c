@@ -8,6 +8,7 @@
 
 #include "script.h"
 #include "actors.h"
+#include "assets.h"
 #include "map.h"
 #include "scriptops.h"
 #include "sound.h"
@@ -132,7 +133,23 @@ typedef struct {
 
 #define script_next(op) ((script_t *) &((op)[1]))
 
+#define SCRIPT_BUILDER_MIN_CAPACITY 64
+
+#ifdef SCRIPT_NATIVE
+// indexed by map id, generated from the maptool -c output
+extern const script_native_table_t *const script_native_tables[NUM_MAPS];
+// interpreted and native runs are profiled separately
+#define SCRIPT_PROFILE_SETS 2
+#else
+#define SCRIPT_PROFILE_SETS 1
+#endif
+
+static SLIST_HEAD(, script_state_s) free_states = SLIST_HEAD_INITIALIZER(free_states);
+
 static script_state_t *script_lookup_script(map_t *map, uint32_t id);
+static script_profile_t *script_profile(script_state_t *state, map_t *map);
+static script_queue_t *script_instances(script_state_t *state, map_t *map);
+static void script_wake(script_state_t *state, map_t *map);
 static actor_target_t script_lookup_target(script_state_t *state, map_t *map, int32_t id);
 static bool script_lookup_position(script_state_t *state, map_t *map, int32_t id, float *x, float *y);
 
@@ -153,25 +170,14 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_JUMP:
     {
       op_jump *op = (void *) script;
-      if (op->target_id >= (uintptr_t) KSEG0_START_ADDR) {
-        state->pc = (script_t *) op->target_id;
-      } else {
-        assertf(op->target_id < map->header->script_count, "invalid script id %"PRIuPTR, op->target_id);
-        state->pc = map->header->scripts[op->target_id];
-      }
+      state->pc = (script_t *) op->target_id;
     }
     break;
   case OP_CALL:
     {
       op_jump *op = (void *) script;
-      assertf(state->stack_pos < SCRIPT_RET_STACK_SIZE - 1, "script return stack overflow");
       state->stack[state->stack_pos++] = script_next(op);
-      if (op->target_id >= (uintptr_t) KSEG0_START_ADDR) {
-        state->pc = (script_t *) op->target_id;
-      } else {
-        assertf(op->target_id < map->header->script_count, "invalid script id %"PRIuPTR, op->target_id);
-        state->pc = map->header->scripts[op->target_id];
-      }
+      state->pc = (script_t *) op->target_id;
     }
     break;
   case OP_EXEC:
@@ -185,23 +191,21 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
     break;
   case OP_SINGLETON:
     {
-      script_state_t *active;
-      TAILQ_FOREACH(active, &map->active_scripts, entry) {
-        if (state != active && active->id == state->id)
-          return RET_EXIT;
-      }
+      script_queue_t *instances = script_instances(state, map);
+      if (TAILQ_FIRST(instances) != state || TAILQ_NEXT(state, instance_entry))
+        return RET_EXIT;
       state->pc = script_next(script);
     }
     break;
   case OP_START_SCRIPT:
     {
       op_jump *op = (void *) script;
-      if (op->target_id >= (uintptr_t) KSEG0_START_ADDR) {
+      if (op->target_id >= (uintptr_t) KSEG0_START_ADDR)
         state->child = script_start_dynamic(map, (dynscript_t *) op->target_id, state->caller);
-      } else {
-        assertf(op->target_id < map->header->script_count, "invalid script id %"PRIuPTR, op->target_id);
+      else
         state->child = script_start(map, op->target_id, state->caller);
-      }
+      if (state->child)
+        state->child->parent = state;
       state->pc = script_next(op);
     }
     break;
@@ -209,11 +213,15 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
     {
       op_id *op = (void *) script;
       if (op->id == SCRIPT_ID_CHILD) {
-        if (state->child)
+        if (state->child) {
+          state->wait = SW_CHILD;
           return RET_WAIT;
+        }
       } else {
-        if (script_lookup_script(map, op->id))
+        if (script_lookup_script(map, op->id)) {
+          state->wait = SW_SCRIPT;
           return RET_WAIT;
+        }
       }
       state->pc = script_next(op);
     }
@@ -240,10 +248,8 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
           script_destroy(state->child, map);
       } else {
         script_state_t *other, *next;
-        TAILQ_FOREACH_SAFE(other, &map->active_scripts, entry, next) {
-          if (other->id == op->id)
-            script_destroy(other, map);
-        }
+        TAILQ_FOREACH_SAFE(other, &map->script_instances[op->id], instance_entry, next)
+          script_destroy(other, map);
       }
       state->pc = script_next(op);
     }
@@ -259,14 +265,14 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_DELAY:
     {
       op_timer *op = (void *) script;
-      if (!state->waiting) {
-        state->counter = op->frames;
-        state->waiting = true;
-      } else if (state->counter == 0) {
+      if (state->waiting || op->frames == 0) {
         state->pc = script_next(op);
         state->waiting = false;
       } else {
-        state->counter--;
+        // counter holds the frame to wake up on
+        state->counter = map->frame_counter + op->frames;
+        state->waiting = true;
+        state->wait = SW_TIMER;
         return RET_WAIT;
       }
     }
@@ -274,16 +280,20 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_WAIT_STATE:
     {
       op_changestate *op = (void *) script;
-      if (map->state_flags & op->flags)
+      if (map->state_flags & op->flags) {
+        state->wait = SW_STATE;
         return RET_WAIT;
+      }
       state->pc = script_next(op);
     }
     break;
   case OP_ACQUIRE_STATE:
     {
       op_changestate *op = (void *) script;
-      if (map->state_flags & op->flags)
+      if (map->state_flags & op->flags) {
+        state->wait = SW_STATE;
         return RET_WAIT;
+      }
       map->state_flags |= op->flags;
       state->pc = script_next(op);
     }
@@ -293,6 +303,7 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
       op_changestate *op = (void *) script;
       assertf(map->state_flags & op->flags, "state %08"PRIx32" released twice", op->flags);
       map->state_flags &= ~op->flags;
+      script_notify(map, SW_STATE);
       state->pc = script_next(op);
     }
     break;
@@ -306,16 +317,12 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_SHOW_DIALOG:
     {
       op_showdialog *op = (void *) script;
-      if (map->dialog_text)
+      if (map->dialog_text) {
+        state->wait = SW_DIALOG;
         return RET_WAIT;
-      const char *text;
-      actor_t *target = NULL;
-      if (op->text >= (uintptr_t) KSEG0_START_ADDR) {
-        text = (const char *) op->text;
-      } else {
-        assertf(op->text < map->header->text_count, "invalid text id %"PRIuPTR, op->text);
-        text = map->header->texts[op->text];
       }
+      const char *text = (const char *) op->text;
+      actor_t *target = NULL;
       if (op->target == TARGET_CALLER)
         target = state->caller;
       else if (op->target > 0)
@@ -325,15 +332,17 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
     }
     break;
   case OP_WAIT_DIALOG:
-    if (map->dialog_text)
+    if (map->dialog_text) {
+      state->wait = SW_DIALOG;
       return RET_WAIT;
-    else
-      state->pc = script_next(script);
+    }
+    state->pc = script_next(script);
     break;
   case OP_MOVE_CAMERA:
     {
       op_movecamera *op = (void *) script;
       if (map->state_flags & MSF_CAMERA_MOVING) {
+        state->wait = SW_STATE;
         return RET_WAIT;
       } else {
         map->state_flags |= MSF_CAMERA_MOVING;
@@ -355,6 +364,7 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
     {
       op_movewater *op = (void *) script;
       if (map->state_flags & MSF_WATER_MOVING) {
+        state->wait = SW_STATE;
         return RET_WAIT;
       } else {
         map->state_flags |= MSF_WATER_MOVING;
@@ -401,7 +411,6 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_PLAY_SOUND:
     {
       op_playsound *op = (void *) script;
-      assertf(op->actor > 0 || op->actor == TARGET_CALLER, "invalid actor id");
       if (op->actor == TARGET_CALLER) {
         if (state->caller)
           actor_play_fx(state->caller, op->sound, op->priority);
@@ -420,12 +429,7 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_SPAWN_ACTOR:
     {
       op_spawnactor *op = (void *) script;
-      if (op->spawn >= (uintptr_t) KSEG0_START_ADDR) {
-        actor_spawn(map, (actor_spawn_t *) op->spawn);
-      } else {
-        assertf(op->spawn < map->header->actor_spawn_count, "invalid actor spawn id %"PRIuPTR, op->spawn);
-        actor_spawn(map, &map->header->actor_spawns[op->spawn]);
-      }
+      actor_spawn(map, (actor_spawn_t *) op->spawn);
       state->pc = script_next(op);
     }
     break;
@@ -441,7 +445,6 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_SET_ACTOR_STATE:
     {
       op_setactorstate *op = (void *) script;
-      assertf(op->actor > 0 || op->actor == TARGET_CALLER, "invalid actor id");
       if (op->actor == TARGET_CALLER) {
         if (state->caller)
           state->caller->flags = (state->caller->flags & op->mask) | op->bits;
@@ -460,8 +463,6 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_SET_ACTOR_TARGET:
     {
       op_setactortarget *op = (void *) script;
-      assertf(op->actor > 0 || op->actor == TARGET_CALLER, "invalid actor id");
-      assertf(op->actor != op->target, "actor cannot target itself");
       actor_target_t target = script_lookup_target(state, map, op->target);
       if (target.actor) {
         if (op->actor == TARGET_CALLER) {
@@ -481,7 +482,6 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_DAMAGE_ACTOR:
     {
       op_damageactor *op = (void *) script;
-      assertf(op->actor > 0 || op->actor == TARGET_CALLER, "invalid actor id");
       if (op->actor == TARGET_CALLER) {
         if (state->caller && state->caller->cls->damage)
           state->caller->cls->damage(map, state->caller, op->damage, op->source);
@@ -498,8 +498,7 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   case OP_DESTROY_ACTOR:
     {
       op_id *op = (void *) script;
-      assertf(op->id > 0, "invalid actor id");
-      if (op->id == TARGET_CALLER) {
+      if (op->id == (uint32_t) TARGET_CALLER) {
         if (state->caller)
           actor_destroy(map, state->caller);
       } else {
@@ -521,10 +520,11 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
     }
     break;
   case OP_WAIT_EARTHQUAKE:
-    if (map->quake_counter)
+    if (map->quake_counter) {
+      state->wait = SW_EARTHQUAKE;
       return RET_WAIT;
-    else
-      state->pc = script_next(script);
+    }
+    state->pc = script_next(script);
     break;
   default:
     assertf(0, "unknown script opcode %"PRIu32, script->opcode);
@@ -533,40 +533,166 @@ static script_ret_t script_step(script_state_t *state, map_t *map) {
   return RET_CONTINUE;
 }
 
+script_ret_t script_native_step(script_state_t *state, map_t *map) {
+  return script_step(state, map);
+}
+
+#ifdef SCRIPT_NATIVE
+static script_native_t script_native_lookup(map_t *map, uint32_t script_id) {
+  const script_native_table_t *table = script_native_tables[map->map_id];
+  if (!table || script_id >= table->script_count)
+    return NULL;
+#ifdef SCRIPT_NATIVE_BENCHMARK
+  // give every other run to the interpreter so the profile can compare them,
+  // release builds have no profile so everything runs native
+  uint32_t sets = map->header->script_count + 1;
+  if (map->script_profiles &&
+      map->script_profiles[script_id + sets].runs > map->script_profiles[script_id].runs)
+    return NULL;
+#endif
+  return table->scripts[script_id];
+}
+#endif
+
+static script_state_t *script_state_alloc(void) {
+  if (SLIST_EMPTY(&free_states)) {
+    script_state_t *block = malloc(SCRIPT_STATE_POOL_BLOCK * sizeof(script_state_t));
+    assertf(block != NULL, "out of memory");
+    for (size_t i = 0; i < SCRIPT_STATE_POOL_BLOCK; i++)
+      SLIST_INSERT_HEAD(&free_states, &block[i], free_entry);
+  }
+  script_state_t *state = SLIST_FIRST(&free_states);
+  SLIST_REMOVE_HEAD(&free_states, free_entry);
+  memset(state, 0, sizeof *state);
+  return state;
+}
+
+static void script_state_free(script_state_t *state) {
+  SLIST_INSERT_HEAD(&free_states, state, free_entry);
+}
+
 script_state_t *script_start(map_t *map, uint32_t script_id, actor_t *caller) {
   assertf(script_id < map->header->script_count, "invalid script id %"PRIu32, script_id);
-  script_state_t *state = calloc(1, sizeof(script_state_t));
+  script_state_t *state = script_state_alloc();
   state->id = script_id;
   state->pc = map->header->scripts[script_id];
+#ifdef SCRIPT_NATIVE
+  state->native = script_native_lookup(map, script_id);
+  state->is_native = state->native != NULL;
+#endif
+  state->start_frame = map->frame_counter;
   state->caller = caller;
   if (caller)
     LIST_INSERT_HEAD(&caller->callers, state, caller_entry);
   TAILQ_INSERT_TAIL(&map->active_scripts, state, entry);
+  TAILQ_INSERT_TAIL(&map->script_runqueue, state, sched_entry);
+  TAILQ_INSERT_TAIL(&map->script_instances[script_id], state, instance_entry);
   bool ret = script_tick(state, map);
   if (ret)
     return state;
   return NULL;
 }
 
+static script_queue_t *script_instances(script_state_t *state, map_t *map) {
+  if (state->id >= (uintptr_t) KSEG0_START_ADDR)
+    return &state->dyn->instances;
+  return &map->script_instances[state->id];
+}
+
+static script_queue_t *script_sched_queue(script_state_t *state, map_t *map) {
+  switch (state->wait) {
+  case SW_NONE:
+    return &map->script_runqueue;
+  case SW_TIMER:
+    return &map->script_timers[state->counter & (SCRIPT_TIMER_SLOTS - 1)];
+  default:
+    return &map->script_waitqueues[state->wait];
+  }
+}
+
 void script_destroy(script_state_t *state, map_t *map) {
-  if (state->parent && state->parent->child == state)
+  if (state->parent && state->parent->child == state) {
     state->parent->child = NULL;
+    if (state->parent->wait == SW_CHILD)
+      script_wake(state->parent, map);
+  }
   if (state->child && state->child->parent == state)
     state->child->parent = NULL;
   if (state->caller)
     LIST_REMOVE(state, caller_entry);
   TAILQ_REMOVE(&map->active_scripts, state, entry);
-  if (state->id >= (uintptr_t) KSEG0_START_ADDR)
+  TAILQ_REMOVE(script_sched_queue(state, map), state, sched_entry);
+  TAILQ_REMOVE(script_instances(state, map), state, instance_entry);
+#ifndef NDEBUG
+  script_profile_t *profile = script_profile(state, map);
+  profile->runs++;
+  profile->frames_alive += map->frame_counter - state->start_frame;
+#endif
+  if (state->id >= (uintptr_t) KSEG0_START_ADDR) {
     script_unref(state->dyn);
-  free(state);
+  } else {
+    script_state_t *waiter, *next;
+    TAILQ_FOREACH_SAFE(waiter, &map->script_waitqueues[SW_SCRIPT], sched_entry, next) {
+      op_id *op = (void *) waiter->pc;
+      if (op->id == state->id)
+        script_wake(waiter, map);
+    }
+  }
+  script_state_free(state);
+}
+
+#ifndef NDEBUG
+// ticks spent in script_tick calls nested inside the one currently running
+static uint32_t script_nested_ticks;
+
+static void script_profile_account(script_profile_t *profile, uint32_t steps, uint32_t start_ticks, uint32_t outer_nested) {
+  uint32_t elapsed = get_ticks() - start_ticks;
+  profile->instructions += steps;
+  // child scripts started from this one are charged to their own profile
+  profile->ticks += elapsed - script_nested_ticks;
+  script_nested_ticks = outer_nested + elapsed;
 }
+#endif
 
 bool script_tick(script_state_t *state, map_t *map) {
   script_ret_t ret;
+#ifndef NDEBUG
+  script_profile_t *profile = script_profile(state, map);
+  uint32_t outer_nested = script_nested_ticks;
+  script_nested_ticks = 0;
+  uint32_t start_ticks = get_ticks();
+#endif
+  uint32_t steps = 0;
   while (1) {
-    ret = script_step(state, map);
-    if (ret == RET_WAIT)
+    if (state->native)
+      ret = state->native(map, state);
+    else
+      ret = script_step(state, map);
+    steps++;
+#ifndef NDEBUG
+    // the state is gone after RET_EXIT, but the profile entry is not
+    if (ret != RET_CONTINUE)
+      script_profile_account(profile, steps, start_ticks, outer_nested);
+#endif
+    if (SCRIPT_STEP_BUDGET && ret == RET_CONTINUE && steps >= SCRIPT_STEP_BUDGET) {
+      // park it until released from the debug controls
+      debugf("script %p (id %"PRIuPTR") ran %"PRIu32" instructions without waiting\n",
+          state, state->id, steps);
+      TAILQ_REMOVE(&map->script_runqueue, state, sched_entry);
+      state->wait = SW_BUDGET;
+      TAILQ_INSERT_TAIL(script_sched_queue(state, map), state, sched_entry);
+#ifndef NDEBUG
+      script_profile_account(profile, steps, start_ticks, outer_nested);
+#endif
+      return true;
+    }
+    if (ret == RET_WAIT) {
+      if (state->wait != SW_NONE) {
+        TAILQ_REMOVE(&map->script_runqueue, state, sched_entry);
+        TAILQ_INSERT_TAIL(script_sched_queue(state, map), state, sched_entry);
+      }
       return true;
+    }
     if (ret == RET_EXIT) {
       script_destroy(state, map);
       return false;
@@ -574,6 +700,41 @@ bool script_tick(script_state_t *state, map_t *map) {
   }
 }
 
+void script_sched_init(map_t *map) {
+#ifndef NDEBUG
+  map->script_profiles = calloc((map->header->script_count + 1) * SCRIPT_PROFILE_SETS, sizeof(script_profile_t));
+  assertf(map->script_profiles != NULL, "out of memory");
+#endif
+  TAILQ_INIT(&map->script_runqueue);
+  FOREACH_ARRAY(queue, map->script_waitqueues)
+    TAILQ_INIT(queue);
+  FOREACH_ARRAY(queue, map->script_timers)
+    TAILQ_INIT(queue);
+}
+
+static void script_wake(script_state_t *state, map_t *map) {
+  TAILQ_REMOVE(script_sched_queue(state, map), state, sched_entry);
+  state->wait = SW_NONE;
+  TAILQ_INSERT_TAIL(&map->script_runqueue, state, sched_entry);
+}
+
+void script_wake_timers(map_t *map) {
+  script_queue_t *slot = &map->script_timers[map->frame_counter & (SCRIPT_TIMER_SLOTS - 1)];
+  script_state_t *state, *next;
+  TAILQ_FOREACH_SAFE(state, slot, sched_entry, next) {
+    if ((int32_t) (map->frame_counter - state->counter) >= 0)
+      script_wake(state, map);
+  }
+}
+
+void script_notify(map_t *map, script_wait_t reason) {
+  script_queue_t *queue = &map->script_waitqueues[reason];
+  script_state_t *state;
+  TAILQ_FOREACH(state, queue, sched_entry)
+    state->wait = SW_NONE;
+  TAILQ_CONCAT(&map->script_runqueue, queue, sched_entry);
+}
+
 void script_ref(dynscript_t *script) {
   script->refcount++;
 }
@@ -588,6 +749,210 @@ void script_unref(dynscript_t *script) {
   }
 }
 
+// ********** PROFILER **********
+
+static script_profile_t *script_profile(script_state_t *state, map_t *map) {
+  uint32_t index = state->id;
+  if (state->id >= (uintptr_t) KSEG0_START_ADDR)
+    index = map->header->script_count;
+  if (state->is_native)
+    index += map->header->script_count + 1;
+  return &map->script_profiles[index];
+}
+
+void script_profile_dump(map_t *map) {
+  if (!map->script_profiles)
+    return;
+  // native scripts count one instruction per resume and are marked with n
+  debugf("script  runs  live  instructions  frames alive  time (us)\n");
+  uint32_t sets = map->header->script_count + 1;
+  for (uint32_t index = 0; index < sets * SCRIPT_PROFILE_SETS; index++) {
+    uint32_t id = index % sets;
+    script_profile_t *profile = &map->script_profiles[index];
+    uint32_t live = 0;
+    uint32_t frames_alive = profile->frames_alive;
+    script_state_t *state;
+    TAILQ_FOREACH(state, &map->active_scripts, entry) {
+      if (script_profile(state, map) == profile) {
+        live++;
+        frames_alive += map->frame_counter - state->start_frame;
+      }
+    }
+    if (!profile->runs && !live)
+      continue;
+    if (id < map->header->script_count)
+      debugf("%5"PRIu32"%c", id, index >= sets ? 'n' : ' ');
+    else
+      debugf("   dyn");
+    debugf("  %4"PRIu32"  %4"PRIu32"  %12"PRIu32"  %12"PRIu32"  %9"PRIu32"\n",
+        profile->runs, live, profile->instructions, frames_alive,
+        (uint32_t) ((uint64_t) profile->ticks * 1000000 / TICKS_PER_SECOND));
+  }
+}
+
+// ********** VERIFIER **********
+
+static const uint8_t script_op_sizes[] = {
+  [OP_NOOP] = sizeof(script_t),
+  [OP_EXIT] = sizeof(script_t),
+  [OP_RET] = sizeof(script_t),
+  [OP_JUMP] = sizeof(op_jump),
+  [OP_CALL] = sizeof(op_jump),
+  [OP_EXEC] = sizeof(op_exec),
+  [OP_SINGLETON] = sizeof(script_t),
+  [OP_START_SCRIPT] = sizeof(op_jump),
+  [OP_WAIT_SCRIPT] = sizeof(op_id),
+  [OP_STOP_ONE_SCRIPT] = sizeof(op_id),
+  [OP_STOP_SCRIPTS] = sizeof(op_id),
+  [OP_STOP_ALL_SCRIPTS] = sizeof(script_t),
+  [OP_DELAY] = sizeof(op_timer),
+  [OP_WAIT_STATE] = sizeof(op_changestate),
+  [OP_ACQUIRE_STATE] = sizeof(op_changestate),
+  [OP_RELEASE_STATE] = sizeof(op_changestate),
+  [OP_FORCE_STATE] = sizeof(op_changestate),
+  [OP_SHOW_DIALOG] = sizeof(op_showdialog),
+  [OP_WAIT_DIALOG] = sizeof(script_t),
+  [OP_MOVE_CAMERA] = sizeof(op_movecamera),
+  [OP_MOVE_WATER] = sizeof(op_movewater),
+  [OP_SET_GRAVITY] = sizeof(op_setgravity),
+  [OP_LOAD_MAP] = sizeof(op_loadmap),
+  [OP_CHANGE_MUSIC] = sizeof(op_changemusic),
+  [OP_PLAY_SOUND] = sizeof(op_playsound),
+  [OP_SPAWN_ACTOR] = sizeof(op_spawnactor),
+  [OP_SPAWN_PARTICLES] = sizeof(op_spawnparticles),
+  [OP_SET_ACTOR_STATE] = sizeof(op_setactorstate),
+  [OP_SET_ACTOR_TARGET] = sizeof(op_setactortarget),
+  [OP_DAMAGE_ACTOR] = sizeof(op_damageactor),
+  [OP_DESTROY_ACTOR] = sizeof(op_id),
+  [OP_EARTHQUAKE] = sizeof(op_earthquake),
+  [OP_WAIT_EARTHQUAKE] = sizeof(script_t),
+};
+
+static script_t *script_verify_next(uint32_t id, script_t *script) {
+  uint32_t opcode = script->opcode;
+  assertf(opcode < COUNT_OF(script_op_sizes) && script_op_sizes[opcode],
+      "script %"PRIu32": unknown opcode %"PRIu32, id, opcode);
+  if (opcode == OP_EXIT || opcode == OP_RET || opcode == OP_JUMP)
+    return NULL;
+  return (script_t *) (((uint8_t *) script) + script_op_sizes[opcode]);
+}
+
+static void script_verify_actor(uint32_t id, int32_t actor) {
+  assertf(actor > 0 || actor == TARGET_CALLER, "script %"PRIu32": invalid actor id %"PRIi32, id, actor);
+}
+
+// explored holds 1 + the deepest call depth each script was walked at
+static void script_verify_calls(map_t *map, uint8_t *explored, uint32_t id, uint8_t depth) {
+  assertf(depth <= SCRIPT_RET_STACK_SIZE, "script %"PRIu32": return stack overflow", id);
+  if (explored[id] > depth)
+    return;
+  explored[id] = depth + 1;
+  for (script_t *script = map->header->scripts[id]; script; script = script_verify_next(id, script)) {
+    if (script->opcode == OP_JUMP || script->opcode == OP_CALL) {
+      op_jump *op = (void *) script;
+      assertf(op->target_id < map->header->script_count, "script %"PRIu32": invalid script id %"PRIuPTR, id, op->target_id);
+      script_verify_calls(map, explored, op->target_id, depth + (script->opcode == OP_CALL));
+    }
+  }
+}
+
+void script_verify(map_t *map) {
+  map_header_t *header = map->header;
+  uint8_t *explored = calloc(header->script_count, sizeof(uint8_t));
+  assertf(header->script_count == 0 || explored != NULL, "out of memory");
+  for (uint32_t id = 0; id < header->script_count; id++)
+    script_verify_calls(map, explored, id, 0);
+  free(explored);
+
+  // resolve ids to pointers so script_step does not have to check them, ops
+  // can be shared between identical scripts so skip anything already resolved
+  for (uint32_t id = 0; id < header->script_count; id++) {
+    for (script_t *script = header->scripts[id]; script; script = script_verify_next(id, script)) {
+      switch (script->opcode) {
+      case OP_JUMP:
+      case OP_CALL:
+        {
+          op_jump *op = (void *) script;
+          if (op->target_id < (uintptr_t) KSEG0_START_ADDR)
+            op->target_id = (uintptr_t) header->scripts[op->target_id];
+        }
+        break;
+      case OP_EXEC:
+        assertf(0, "script %"PRIu32": native calls are not allowed in map scripts", id);
+        break;
+      case OP_START_SCRIPT:
+        {
+          op_jump *op = (void *) script;
+          assertf(op->target_id < header->script_count, "script %"PRIu32": invalid script id %"PRIuPTR, id, op->target_id);
+        }
+        break;
+      case OP_WAIT_SCRIPT:
+      case OP_STOP_ONE_SCRIPT:
+      case OP_STOP_SCRIPTS:
+        {
+          op_id *op = (void *) script;
+          assertf(op->id == SCRIPT_ID_CHILD || op->id < header->script_count,
+              "script %"PRIu32": invalid script id %"PRIu32, id, op->id);
+        }
+        break;
+      case OP_SHOW_DIALOG:
+        {
+          op_showdialog *op = (void *) script;
+          if (op->text < (uintptr_t) KSEG0_START_ADDR) {
+            assertf(op->text < header->text_count, "script %"PRIu32": invalid text id %"PRIuPTR, id, op->text);
+            op->text = (uintptr_t) header->texts[op->text];
+          }
+        }
+        break;
+      case OP_LOAD_MAP:
+        {
+          op_loadmap *op = (void *) script;
+          assertf(op->map < NUM_MAPS, "script %"PRIu32": invalid map id %"PRIu32, id, op->map);
+        }
+        break;
+      case OP_CHANGE_MUSIC:
+        {
+          op_changemusic *op = (void *) script;
+          assertf(op->music < NUM_MUS, "script %"PRIu32": invalid music id %"PRIu32, id, op->music);
+        }
+        break;
+      case OP_PLAY_SOUND:
+        {
+          op_playsound *op = (void *) script;
+          script_verify_actor(id, op->actor);
+          assertf(op->sound < NUM_SFX, "script %"PRIu32": invalid sound id %"PRIu32, id, op->sound);
+        }
+        break;
+      case OP_SPAWN_ACTOR:
+        {
+          op_spawnactor *op = (void *) script;
+          if (op->spawn < (uintptr_t) KSEG0_START_ADDR) {
+            assertf(op->spawn < header->actor_spawn_count, "script %"PRIu32": invalid actor spawn id %"PRIuPTR, id, op->spawn);
+            op->spawn = (uintptr_t) &header->actor_spawns[op->spawn];
+          }
+        }
+        break;
+      case OP_SET_ACTOR_STATE:
+        script_verify_actor(id, ((op_setactorstate *) script)->actor);
+        break;
+      case OP_SET_ACTOR_TARGET:
+        {
+          op_setactortarget *op = (void *) script;
+          script_verify_actor(id, op->actor);
+          assertf(op->actor != op->target, "script %"PRIu32": actor cannot target itself", id);
+        }
+        break;
+      case OP_DAMAGE_ACTOR:
+        script_verify_actor(id, ((op_damageactor *) script)->actor);
+        break;
+      case OP_DESTROY_ACTOR:
+        script_verify_actor(id, ((op_id *) script)->id);
+        break;
+      }
+    }
+  }
+}
+
 static actor_target_t script_lookup_target(script_state_t *state, map_t *map, int32_t id) {
   actor_target_t target = { .is_waypoint = false };
   if (id == TARGET_CALLER) {
@@ -635,12 +1000,7 @@ static bool script_lookup_position(script_state_t *state, map_t *map, int32_t id
 }
 
 static script_state_t *script_lookup_script(map_t *map, uint32_t id) {
-  script_state_t *active;
-  TAILQ_FOREACH(active, &map->active_scripts, entry) {
-    if (active->id == id)
-      return active;
-  }
-  return NULL;
+  return TAILQ_FIRST(&map->script_instances[id]);
 }
 
 void script_builder_init(script_builder_t *builder) {
@@ -650,7 +1010,12 @@ void script_builder_init(script_builder_t *builder) {
 static script_t *script_builder_extend(script_builder_t *builder, size_t extra, uint32_t opcode) {
   size_t old_size = builder->script_size;
   builder->script_size += extra;
-  builder->script = realloc(builder->script, builder->script_size);
+  if (builder->script_size > builder->script_capacity) {
+    builder->script_capacity = MAX(builder->script_capacity * 2,
+        MAX(builder->script_size, SCRIPT_BUILDER_MIN_CAPACITY));
+    builder->script = realloc(builder->script, builder->script_capacity);
+    assertf(builder->script != NULL, "out of memory");
+  }
 
   script_t *script = (script_t *) (((uint8_t *) builder->script) + old_size);
   script->opcode = opcode;
@@ -665,11 +1030,12 @@ static dynscript_t *script_builder_finish(script_builder_t *builder) {
   dynscript_t *script = malloc(sizeof(dynscript_t) + builder->free_ptr_count * sizeof(void *));
   script->script = builder->script;
   script->refcount = 1;
+  TAILQ_INIT(&script->instances);
   script->free_count = builder->free_ptr_count;
-  if (builder->free_ptr_count) {
+  if (builder->free_ptr_count)
     memcpy(&script->free_ptrs[0], builder->free_ptrs, builder->free_ptr_count * sizeof(void *));
+  if (builder->free_ptrs)
     free(builder->free_ptrs);
-  }
   memset(builder, 0, sizeof *builder);
   return script;
 }
@@ -677,7 +1043,11 @@ static dynscript_t *script_builder_finish(script_builder_t *builder) {
 static void script_builder_push_free(script_builder_t *builder, void *ptr) {
   size_t end_index = builder->free_ptr_count;
   builder->free_ptr_count++;
-  builder->free_ptrs = realloc(builder->free_ptrs, builder->free_ptr_count * sizeof(void *));
+  if (builder->free_ptr_count > builder->free_ptr_capacity) {
+    builder->free_ptr_capacity = MAX(builder->free_ptr_capacity * 2, 4);
+    builder->free_ptrs = realloc(builder->free_ptrs, builder->free_ptr_capacity * sizeof(void *));
+    assertf(builder->free_ptrs != NULL, "out of memory");
+  }
   builder->free_ptrs[end_index] = ptr;
 }
 
@@ -717,8 +1087,9 @@ script_t *script_builder_push_dialogf(script_builder_t *builder, int32_t target,
 script_t *script_builder_push_spawn_actor(script_builder_t *builder, void *alloc_arg, actor_spawn_t **spawn) {
   op_spawnactor *op = script_builder_push(builder, op, OP_SPAWN_ACTOR);
   *spawn = malloc(sizeof(actor_spawn_t));
-  op->spawn = (uintptr_t) spawn;
-  script_builder_push_free(builder, spawn);
+  assertf(*spawn != NULL, "out of memory");
+  op->spawn = (uintptr_t) *spawn;
+  script_builder_push_free(builder, *spawn);
   if (alloc_arg != NULL) {
     (*spawn)->arg = alloc_arg;
     script_builder_push_free(builder, alloc_arg);
@@ -727,14 +1098,17 @@ script_t *script_builder_push_spawn_actor(script_builder_t *builder, void *alloc
 }
 
 script_state_t *script_start_dynamic(map_t *map, dynscript_t *script, actor_t *caller) {
-  script_state_t *state = calloc(1, sizeof(script_state_t));
+  script_state_t *state = script_state_alloc();
   script_ref(script);
   state->dyn = script;
   state->pc = script->script;
+  state->start_frame = map->frame_counter;
   state->caller = caller;
   if (caller)
     LIST_INSERT_HEAD(&caller->callers, state, caller_entry);
   TAILQ_INSERT_TAIL(&map->active_scripts, state, entry);
+  TAILQ_INSERT_TAIL(&map->script_runqueue, state, sched_entry);
+  TAILQ_INSERT_TAIL(&script->instances, state, instance_entry);
   bool ret = script_tick(state, map);
   if (ret)
     return state;
@@ -754,7 +1128,7 @@ dynscript_t *script_builder_finish_ret(script_builder_t *builder, map_t *map) {
 dynscript_t *script_builder_finish_jump(script_builder_t *builder, map_t *map, uint32_t id) {
   assertf(id < map->header->script_count, "invalid script id %"PRIu32, id);
   op_jump *end = script_builder_push(builder, end, OP_JUMP);
-  end->target_id = id;
+  end->target_id = (uintptr_t) map->header->scripts[id];
   return script_builder_finish(builder);
 }
 
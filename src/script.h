@@ -9,6 +9,18 @@ extern "C" {
 #endif
 
 #define SCRIPT_RET_STACK_SIZE 4
+#define SCRIPT_TIMER_SLOTS 64
+#define SCRIPT_STATE_POOL_BLOCK 16
+
+// instructions a script may execute in one tick before it is parked in
+// SW_BUDGET until released from the debug controls, 0 disables the limit.
+// release builds have no debug controls, so they never park scripts
+#ifdef NDEBUG
+#undef SCRIPT_STEP_BUDGET
+#define SCRIPT_STEP_BUDGET 0
+#elif !defined(SCRIPT_STEP_BUDGET)
+#define SCRIPT_STEP_BUDGET 4096
+#endif
 
 typedef struct map_s map_t;
 typedef struct actor_s actor_t;
@@ -18,48 +30,104 @@ typedef struct {
   uint32_t opcode;
 } script_t;
 
+TAILQ_HEAD(script_queue_s, script_state_s);
+typedef struct script_queue_s script_queue_t;
+
 typedef struct {
   script_t *script;
   uint32_t refcount;
+  script_queue_t instances;
   size_t free_count;
   void *free_ptrs[];
 } dynscript_t;
 
-typedef struct script_state_s {
+// what a parked script is waiting on, scripts in SW_NONE are ticked every frame
+typedef enum {
+  SW_NONE,
+  SW_TIMER,
+  SW_STATE,
+  SW_DIALOG,
+  SW_EARTHQUAKE,
+  SW_SCRIPT,
+  SW_CHILD,
+  SW_BUDGET,
+  SW_COUNT,
+} script_wait_t;
+
+typedef struct script_state_s script_state_t;
+
+typedef enum {
+  RET_CONTINUE,
+  RET_WAIT,
+  RET_EXIT,
+} script_ret_t;
+
+typedef script_ret_t (*script_exec_t)(map_t *, script_state_t *);
+
+// map script compiled to C by maptool -c, resumes at state->resume and keeps
+// state->pc on the op it is executing so it can hand over to the interpreter
+typedef script_ret_t (*script_native_t)(map_t *, script_state_t *);
+
+typedef struct {
+  uint32_t script_count;
+  const script_native_t *scripts;
+} script_native_table_t;
+
+struct script_state_s {
   union {
     uintptr_t id;
     dynscript_t *dyn;
   };
   script_t *pc;
+  script_native_t native;
   script_t *stack[SCRIPT_RET_STACK_SIZE];
   uint8_t stack_pos;
   bool waiting;
+  uint8_t wait;
+  bool is_native;
+  uint16_t resume;
   uint32_t counter;
+  uint32_t start_frame;
   struct script_state_s *parent;
   struct script_state_s *child;
   TAILQ_ENTRY(script_state_s) entry;
+  TAILQ_ENTRY(script_state_s) sched_entry;
+  TAILQ_ENTRY(script_state_s) instance_entry;
+  SLIST_ENTRY(script_state_s) free_entry;
   actor_t *caller;
   LIST_ENTRY(script_state_s) caller_entry;
-} script_state_t;
+};
+
+// per map script id, dynamic scripts share one entry after the map scripts
+typedef struct {
+  uint32_t runs;
+  uint32_t instructions;
+  uint32_t frames_alive;
+  uint32_t ticks;
+} script_profile_t;
 
 typedef struct {
   script_t *script;
   size_t script_size;
+  size_t script_capacity;
   void **free_ptrs;
   size_t free_ptr_count;
+  size_t free_ptr_capacity;
 } script_builder_t;
 
-typedef enum {
-  RET_CONTINUE,
-  RET_WAIT,
-  RET_EXIT,
-} script_ret_t;
-
-typedef script_ret_t (*script_exec_t)(map_t *, script_state_t *);
-
 script_state_t *script_start(map_t *map, uint32_t script_id, actor_t *caller);
 bool script_tick(script_state_t *state, map_t *map);
 void script_destroy(script_state_t *state, map_t *map);
+// runs the bytecode op at state->pc once, for ops native scripts do not inline
+script_ret_t script_native_step(script_state_t *state, map_t *map);
+
+void script_verify(map_t *map);
+
+void script_profile_dump(map_t *map);
+
+void script_sched_init(map_t *map);
+void script_wake_timers(map_t *map);
+void script_notify(map_t *map, script_wait_t reason);
 
 void script_ref(dynscript_t *script);
 void script_unref(dynscript_t *script);
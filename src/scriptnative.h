@@ -0,0 +1,64 @@
+#pragma once
+
+// helpers for the map scripts maptool -c compiles to C, every op gets a case
+// label so a script can resume at the op it waited on
+
+#include <libdragon.h>
+
+#include "map.h"
+#include "script.h"
+#include "sound.h"
+#include "util.h"
+#include "world.h"
+
+#define SCRIPT_NATIVE_PC(script, offset) \
+  ((script_t *) (((uint8_t *) map->header->scripts[(script)]) + (offset)))
+
+#define SCRIPT_NATIVE_BEGIN() switch (state->resume) { case 0:
+#define SCRIPT_NATIVE_END() } return RET_EXIT;
+
+// park the script on reason, it runs the same op again when woken
+#define SCRIPT_NATIVE_WAIT(n, script, offset, reason) \
+  do { \
+    state->resume = (n); \
+    state->pc = SCRIPT_NATIVE_PC((script), (offset)); \
+    state->wait = (reason); \
+    return RET_WAIT; \
+  } while (0)
+
+// run a single op in the interpreter
+#define SCRIPT_NATIVE_STEP(n, script, offset) \
+  do { \
+    state->resume = (n); \
+    state->pc = SCRIPT_NATIVE_PC((script), (offset)); \
+    script_ret_t ret = script_native_step(state, map); \
+    if (ret != RET_CONTINUE) \
+      return ret; \
+  } while (0)
+
+// leave the rest of the script to the interpreter
+#define SCRIPT_NATIVE_HANDOFF(script, offset) \
+  do { \
+    state->native = NULL; \
+    state->pc = SCRIPT_NATIVE_PC((script), (offset)); \
+    return RET_CONTINUE; \
+  } while (0)
+
+// returns to script_tick so loops count against the step budget
+#define SCRIPT_NATIVE_JUMP(func, script) \
+  do { \
+    state->native = (func); \
+    state->resume = 0; \
+    state->pc = map->header->scripts[(script)]; \
+    return RET_CONTINUE; \
+  } while (0)
+
+#define SCRIPT_NATIVE_DELAY(n, script, offset, frames) \
+  do { \
+    if (!state->waiting) { \
+      state->counter = map->frame_counter + (frames); \
+      state->waiting = true; \
+      SCRIPT_NATIVE_WAIT((n), (script), (offset), SW_TIMER); \
+    } \
+    state->waiting = false; \
+  } while (0)
@@ -1,6 +1,8 @@
 
 #include <float.h>
 #include <libdragon.h>
+#include <math.h>
+#include <string.h>
 
 #include "assets.h"
 #include "sound.h"
@@ -21,7 +23,10 @@
 #define NUM_CHANNELS 20
 
 #define CHANNEL_MUSIC 0
-#define MAX_SFX_CHANNEL (NUM_CHANNELS - 1)
+
+// sounds play on virtual voices, every audio update the loudest audible ones
+// get the mixer channels the music leaves free and the rest only keep time
+#define MAX_VOICES 48
 
 static xm64player_t xmplayer;
 
@@ -51,26 +56,27 @@ static mus_id_t pending_music = MUS_NONE;
 static float music_fade_vol = 1.0;
 static float music_fade_step;
 
-static struct {
-  sfx_id_t sound;
+typedef struct {
+  sfx_id_t sound; // SFX_NONE when free
   int priority;
+  int channel; // -1 while virtual
+  bool paused;
+  float pos; // in samples of the sound
+  float att;
   float lvol;
   float rvol;
-  float pos;
   float x;
   float y;
   int *ptr;
-} current_sfxs[NUM_CHANNELS] = {};
-int last_sfx_channel = MAX_SFX_CHANNEL - 1;
-int ambient_channel = -1;
+} voice_t;
+
+static voice_t voices[MAX_VOICES];
+static int8_t channel_voices[NUM_CHANNELS]; // -1 when free
 
 static int first_fx_channel(void) {
   return xmplayer.ctx ? xm64player_num_channels(&xmplayer) : 0;
 }
 
-#define FOREACH_SFX_CHAN(var) \
-  for (int var = first_fx_channel(); var < MAX_SFX_CHANNEL; var++)
-
 static float distance_atttenuation(float x, float y) {
   x -= listener_x;
   y -= listener_y;
@@ -83,20 +89,130 @@ static float distance_atttenuation(float x, float y) {
   return r_sq * r_sq;
 }
 
-static int unset_channel_pointer(void *ptr) {
-  current_sfxs[*(int *)ptr].ptr = NULL;
-  *(int *)ptr = -1;
-  return 0;
+static float voice_attenuation(voice_t *voice) {
+  if (voice->x == FLT_MAX)
+    return 1.0;
+  return distance_atttenuation(voice->x, voice->y);
+}
+
+// the voice keeps its place in the sound while it has no channel
+static void voice_demote(voice_t *voice) {
+  if (voice->channel < 0)
+    return;
+  voice->pos = mixer_ch_get_pos(voice->channel);
+  mixer_ch_stop(voice->channel);
+  channel_voices[voice->channel] = -1;
+  voice->channel = -1;
+}
+
+static void voice_promote(voice_t *voice, int channel) {
+  wav64_play(&sfxs[voice->sound], channel);
+  if (voice->pos > 0)
+    mixer_ch_set_pos(channel, voice->pos);
+  channel_voices[channel] = voice - voices;
+  voice->channel = channel;
+}
+
+static void voice_free(voice_t *voice) {
+  if (voice->channel >= 0) {
+    mixer_ch_stop(voice->channel);
+    channel_voices[voice->channel] = -1;
+  }
+  if (voice->ptr)
+    *voice->ptr = -1;
+  memset(voice, 0, sizeof(voice_t));
+  voice->channel = -1;
+}
+
+// returns false once a one shot has run out
+static bool voice_advance(voice_t *voice, size_t numsamples) {
+  if (voice->channel >= 0) {
+    if (!mixer_ch_playing(voice->channel))
+      return false;
+    voice->pos = mixer_ch_get_pos(voice->channel);
+    return true;
+  }
+  const waveform_t *wave = &sfxs[voice->sound].wave;
+  voice->pos += numsamples * wave->frequency * (1.0f / AUDIO_FREQ);
+  if (voice->pos < wave->len)
+    return true;
+  if (!wave->loop_len)
+    return false;
+  float loop_start = wave->len - wave->loop_len;
+  voice->pos = loop_start + fmodf(voice->pos - loop_start, wave->loop_len);
+  return true;
+}
+
+static int voice_find_channel(void) {
+  for (int ch = first_fx_channel(); ch < NUM_CHANNELS; ch++) {
+    if (channel_voices[ch] < 0)
+      return ch;
+  }
+  return -1;
+}
+
+// louder first, priority breaks ties
+static bool voice_outranks(const voice_t *a, const voice_t *b) {
+  if (a->att != b->att)
+    return a->att > b->att;
+  return a->priority > b->priority;
 }
 
-static void stop_sfx(int ch) {
-  if (mixer_ch_playing(ch)) {
-    mixer_ch_stop(ch);
-    current_sfxs[ch].sound = SFX_NONE;
-    if (current_sfxs[ch].ptr) {
-      unset_channel_pointer(current_sfxs[ch].ptr);
-      mixer_remove_event(unset_channel_pointer, current_sfxs[ch].ptr);
+static void sound_update_voices(size_t numsamples) {
+  voice_t *audible[MAX_VOICES];
+  int count = 0;
+  for (int i = 0; i < MAX_VOICES; i++) {
+    voice_t *voice = &voices[i];
+    if (voice->sound == SFX_NONE || voice->paused)
+      continue;
+    if (!voice_advance(voice, numsamples)) {
+      voice_free(voice);
+      continue;
+    }
+    voice->att = voice_attenuation(voice);
+    if (voice->att <= 0.0) {
+      voice_demote(voice);
+      continue;
+    }
+    int j = count++;
+    for (; j > 0 && voice_outranks(voice, audible[j - 1]); j--)
+      audible[j] = audible[j - 1];
+    audible[j] = voice;
+  }
+
+  // free the channels of the voices that lost out before handing them on
+  int slots = MAX(NUM_CHANNELS - first_fx_channel(), 0);
+  for (int i = slots; i < count; i++)
+    voice_demote(audible[i]);
+  count = MIN(count, slots);
+
+  for (int i = 0; i < count; i++) {
+    voice_t *voice = audible[i];
+    if (voice->channel < 0) {
+      int channel = voice_find_channel();
+      if (channel < 0)
+        continue;
+      voice_promote(voice, channel);
     }
+    float lvol, rvol;
+    float x = voice->x;
+    if (x != FLT_MAX) {
+      float att = voice->att;
+      if (x < listener_x) {
+        lvol = att;
+        rvol = MAX(1.0 - (listener_x - x) * INV_PAN_WIDTH, 0.0);
+      } else if (x > listener_x) {
+        rvol = att;
+        lvol = MAX(1.0 - (x - listener_x) * INV_PAN_WIDTH, 0.0);
+      } else {
+        lvol = rvol = 1.0;
+      }
+    } else {
+      lvol = rvol = 1.0;
+    }
+    voice->lvol = lvol;
+    voice->rvol = rvol;
+    mixer_ch_set_vol(voice->channel, lvol * sfx_volume * 0.1f, rvol * sfx_volume * .1f);
   }
 }
 
@@ -114,8 +230,10 @@ static void sound_cb(short *buffer, size_t numsamples) {
       }
       if (current_music) {
         xm64player_open(&xmplayer, mus_paths[current_music]);
-        for (int ch = end_ch; ch < xm64player_num_channels(&xmplayer); ch++)
-          stop_sfx(ch);
+        for (int ch = end_ch; ch < xm64player_num_channels(&xmplayer); ch++) {
+          if (channel_voices[ch] >= 0)
+            voice_demote(&voices[channel_voices[ch]]);
+        }
         xm64player_play(&xmplayer, CHANNEL_MUSIC);
         xm64player_set_loop(&xmplayer, true);
       }
@@ -129,39 +247,14 @@ static void sound_cb(short *buffer, size_t numsamples) {
     if (fade_vol <= 0) {
       fade_vol = 1.0;
       fade_step = 0.0;
-      FOREACH_SFX_CHAN(ch)
-        stop_sfx(ch);
-    }
-    sfx_volume = sfx_user_volume * fade_vol;
-  }
-  FOREACH_SFX_CHAN(channel) {
-    if (mixer_ch_playing(channel)) {
-      float x = current_sfxs[channel].x;
-      float lvol, rvol;
-      if (x != FLT_MAX) {
-        float y = current_sfxs[channel].y;
-        float att = distance_atttenuation(x, y);
-        if (att > 0.0) {
-          if (x < listener_x) {
-            lvol = att;
-            rvol = MAX(1.0 - (listener_x - x) * INV_PAN_WIDTH, 0.0);
-          } else if (x > listener_x) {
-            rvol = att;
-            lvol = MAX(1.0 - (x - listener_x) * INV_PAN_WIDTH, 0.0);
-          } else {
-            lvol = rvol = 1.0;
-          }
-        } else {
-          lvol = rvol = 0.0;
-        }
-        current_sfxs[channel].lvol = lvol;
-        current_sfxs[channel].rvol = rvol;
-      } else {
-        lvol = rvol = 1.0;
+      for (int i = 0; i < MAX_VOICES; i++) {
+        if (voices[i].sound != SFX_NONE)
+          voice_free(&voices[i]);
       }
-      mixer_ch_set_vol(channel, lvol * sfx_volume * 0.1f, rvol * sfx_volume * .1f);
     }
+    sfx_volume = sfx_user_volume * fade_vol;
   }
+  sound_update_voices(numsamples);
   mixer_poll(buffer, numsamples);
 }
 
@@ -226,77 +319,55 @@ void sound_set_listener_pos(float x, float y) {
   //enable_interrupts();
 }
 
-static int find_free_channel(int priority, int *ch) {
-  const int start_ch = first_fx_channel();
-  if (start_ch >= NUM_CHANNELS)
-    return -1;
-
-  int channel;
-  if (ch) {
-    channel = *ch;
-    if (channel < start_ch)
-      channel = -1;
-  } else {
-    channel = -1;
-  }
-
-  if (channel < 0) {
-    channel = -1;
-    for (int search = start_ch; search < NUM_CHANNELS; search++) {
-      if (!mixer_ch_playing(search)) {
-        channel = search;
-        break;
-      }
-    }
-    if (channel == -1) {
-      for (int search = start_ch; search < NUM_CHANNELS; search++) {
-        if (current_sfxs[search].priority < priority) {
-          channel = search;
-          break;
-        }
-      }
-      if (channel == -1) {
-        channel = last_sfx_channel - 1;
-        if (channel < start_ch)
-          channel = NUM_CHANNELS - 1;
-      }
-    }
+// takes a free voice or the weakest one that doesn't outrank the new sound
+static voice_t *voice_alloc(int priority, float att) {
+  voice_t *weakest = NULL;
+  for (int i = 0; i < MAX_VOICES; i++) {
+    voice_t *voice = &voices[i];
+    if (voice->sound == SFX_NONE)
+      return voice;
+    if (voice->priority <= priority && (!weakest || voice_outranks(weakest, voice)))
+      weakest = voice;
   }
-
-  return channel;
+  if (!weakest || (weakest->priority == priority && weakest->att > att))
+    return NULL;
+  voice_free(weakest);
+  return weakest;
 }
 
+// sounds out of earshot still start so they can come into range, ch gets the
+// voice and is reset to -1 when the sound ends
 void sound_play_fx(uint16_t id, float x, float y, int priority, int *ch) {
   assertf(id < NUM_SFX, "invalid sfx id %d", id);
 
   //disable_interrupts();
 
-  float att = distance_atttenuation(x, y);
-  if (att <= 0.0)
-    return;
-
-  int channel = find_free_channel(priority, ch);
-  if (channel < 0)
-    return;
-
-  stop_sfx(channel);
-
-  current_sfxs[channel].sound = id;
-  current_sfxs[channel].pos = 0;
-  current_sfxs[channel].x = x;
-  current_sfxs[channel].y = y;
-  current_sfxs[channel].priority = priority;
-  current_sfxs[channel].ptr = NULL;
-  last_sfx_channel = channel;
-
-  wav64_play(&sfxs[id], channel);
+  float att = x == FLT_MAX ? 1.0 : distance_atttenuation(x, y);
+  voice_t *voice;
+  if (ch && *ch >= 0 && *ch < MAX_VOICES && voices[*ch].ptr == ch) {
+    voice = &voices[*ch];
+    voice_free(voice);
+  } else {
+    voice = voice_alloc(priority, att);
+    if (!voice)
+      return;
+  }
 
+  voice->sound = id;
+  voice->priority = priority;
+  voice->x = x;
+  voice->y = y;
+  voice->att = att;
   if (ch) {
-    *ch = channel;
-    if (!sfxs[id].wave.loop_len) {
-      current_sfxs[channel].ptr = ch;
-      mixer_add_event(sfxs[id].wave.len, unset_channel_pointer, ch);
-    }
+    *ch = voice - voices;
+    voice->ptr = ch;
+  }
+
+  // start right away if there's room, otherwise the next update decides
+  int channel = voice_find_channel();
+  if (att > 0.0 && channel >= 0) {
+    voice_promote(voice, channel);
+    mixer_ch_set_vol(channel, 0, 0);
   }
 
   //enable_interrupts();
@@ -310,8 +381,8 @@ void sound_update_position(int ch, float x, float y) {
   if (ch == -1)
     return;
 
-  current_sfxs[ch].x = x;
-  current_sfxs[ch].y = y;
+  voices[ch].x = x;
+  voices[ch].y = y;
 
   //disable_interrupts();
 
@@ -322,20 +393,21 @@ void sound_release_channel(int *ptr) {
   //disable_interrupts();
 
   if (*ptr != -1) {
-    unset_channel_pointer(ptr);
-    mixer_remove_event(unset_channel_pointer, ptr);
+    if (voices[*ptr].ptr == ptr)
+      voices[*ptr].ptr = NULL;
+    *ptr = -1;
   }
 
   //enable_interrupts();
 }
 
+// sounds started while paused, like the menu's, play as usual
 void sound_pause_fx(void) {
   //disable_interrupts();
-  FOREACH_SFX_CHAN(channel) {
-    if (mixer_ch_playing(channel)) {
-      current_sfxs[channel].pos = mixer_ch_get_pos(channel);
-    } else {
-      current_sfxs[channel].sound = SFX_NONE;
+  for (int i = 0; i < MAX_VOICES; i++) {
+    if (voices[i].sound != SFX_NONE) {
+      voice_demote(&voices[i]);
+      voices[i].paused = true;
     }
   }
   //enable_interrupts();
@@ -343,14 +415,8 @@ void sound_pause_fx(void) {
 
 void sound_resume_fx(void) {
   //disable_interrupts();
-  FOREACH_SFX_CHAN(channel) {
-    if (current_sfxs[channel].sound != SFX_NONE) {
-      wav64_play(&sfxs[current_sfxs[channel].sound], channel);
-      mixer_ch_set_vol(channel, current_sfxs[channel].lvol, current_sfxs[channel].rvol);
-      mixer_ch_set_pos(channel, current_sfxs[channel].pos);
-      current_sfxs[channel].sound = SFX_NONE;
-    }
-  }
+  for (int i = 0; i < MAX_VOICES; i++)
+    voices[i].paused = false;
   //enable_interrupts();
 }
 
@@ -362,6 +428,9 @@ void sound_init(void) {
   mixer_init(NUM_CHANNELS);
   for (size_t i = 0; i < NUM_CHANNELS; i++)
     wav64_play(&sfxs[SFX_NONE], i);
+  memset(channel_voices, -1, sizeof(channel_voices));
+  for (size_t i = 0; i < MAX_VOICES; i++)
+    voices[i].channel = -1;
   /*
   audio_set_buffer_callback(sound_cb);
   while (!audio_can_write()) {}
@@ -25,6 +25,8 @@ void sound_play_music(uint16_t id, float fade_secs, unsigned int flags);
 void sound_set_music_gain(float vol);
 
 void sound_set_listener_pos(float x, float y);
+// ch gets a voice handle for the calls below, it goes back to -1 when the
+// sound ends or is released
 void sound_play_fx(uint16_t id, float x, float y, int priority, int *ch);
 void sound_play_fx_global(uint16_t id, int priority, int *ch);
 void sound_update_position(int ch, float x, float y);
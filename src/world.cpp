@@ -14,15 +14,56 @@
 #include "main.h"
 #include "misc.h"
 
-#define WATER_BOX_SIZE (4096.0)
 #define WATER_DAMPING 0.5f
 
+#define WORLD_ARENA_BLOCK_SIZE (16 * 1024)
+#define WORLD_ALLOC_MIN_SIZE 16
+#define WORLD_ALLOC_CLASSES 8 // 16 to 2048 bytes
+// b2BlockAllocator grabs its pages in b2_chunkSize pieces, which is most of
+// Box2D's memory, so they get a pool of their own
+#define WORLD_ALLOC_CHUNK_SIZE (16 * 1024)
+#define WORLD_ALLOC_CHUNK WORLD_ALLOC_CLASSES
+#define WORLD_ALLOC_LARGE 0xffff
+
+typedef struct {
+  uint16_t size_class;
+  bool counted;
+  uint32_t size;
+} world_alloc_header_t;
+
+typedef struct world_free_s {
+  SLIST_ENTRY(world_free_s) entry;
+} world_free_t;
+
+typedef struct world_arena_block_s {
+  SLIST_ENTRY(world_arena_block_s) entry;
+  uint32_t used;
+  uint8_t data[] __attribute__((aligned(8)));
+} world_arena_block_t;
+
+typedef struct {
+  SLIST_HEAD(, world_arena_block_s) blocks;
+  SLIST_HEAD(, world_arena_block_s) chunks;
+  SLIST_HEAD(, world_free_s) free_lists[WORLD_ALLOC_CLASSES + 1];
+  world_alloc_stats_t stats;
+} world_arena_t;
+
+#define WORLD_VELOCITY_ITERATIONS 6
+#define WORLD_POSITION_ITERATIONS 2
+
 struct world_s {
   map_t *map;
-  b2Body *water;
+  float water_line;
+  bool water_moved;
+  uint8_t velocity_iterations;
+  uint8_t position_iterations;
+  world_arena_t arena;
   b2World world;
 };
 
+// b2Alloc has no world argument, there is only ever one world alive
+static world_arena_t *world_arena;
+
 typedef enum {
   COLL_END = 0,
   COLL_CIRCLE = 1,
@@ -80,46 +121,60 @@ typedef struct {
 
 struct ContactListener : public b2ContactListener {
   void BeginContact(b2Contact *contact) override {
-    this->Handle(contact, nullptr);
+    this->Handle(contact, nullptr, CE_BEGIN);
   }
   void EndContact(b2Contact *contact) override {
-    this->Handle(contact, nullptr);
+    this->Handle(contact, nullptr, CE_END);
   }
+  void Handle(b2Contact *contact, const b2Manifold *old, uint8_t event);
+} contact_listener;
+
+// only installed when some actor class wants presolve, it runs every step for
+// every touching pair
+struct PreSolveContactListener : public ContactListener {
   void PreSolve(b2Contact *contact, const b2Manifold *old) override {
-    this->Handle(contact, old);
+    this->Handle(contact, old, CE_PRESOLVE);
   }
-  void Handle(b2Contact *contact, const b2Manifold *old);
-} contact_listener;
+} presolve_contact_listener;
 
 #ifndef NDEBUG
 static void world_set_debug_draw(world_t *world);
 #endif
 
 static void world_body_add_collision_fixtures(body_t *body, b2FixtureDef fix, collision_t *collision);
+static void world_update_water(world_t *world);
+static void world_set_actor_underwater(actor_t *actor, bool underwater);
 
 world_t *world_new(map_t *map, float gravity_x, float gravity_y, float water_y) {
   world_t *world = static_cast<world_t *>(malloc(sizeof(world_t)));
+  assertf(world != NULL, "out of memory");
   world->map = map;
 
+  assertf(world_arena == NULL, "only one world can be alive");
+  memset(&world->arena, 0, sizeof world->arena);
+  SLIST_INIT(&world->arena.blocks);
+  SLIST_INIT(&world->arena.chunks);
+  FOREACH_ARRAY(free_list, world->arena.free_lists)
+    SLIST_INIT(free_list);
+  world_arena = &world->arena;
+
+  world->velocity_iterations = map->header->velocity_iterations;
+  if (!world->velocity_iterations)
+    world->velocity_iterations = WORLD_VELOCITY_ITERATIONS;
+  world->position_iterations = map->header->position_iterations;
+  if (!world->position_iterations)
+    world->position_iterations = WORLD_POSITION_ITERATIONS;
+
   auto gravity = POINT_SCALE * b2Vec2(gravity_x, gravity_y);
   new (&world->world) b2World(gravity);
+  world->world.SetAutoClearForces(true);
+  world->world.SetAllowSleeping(true);
   gravity.Normalize();
   map->gravity_norm_x = gravity.x;
   map->gravity_norm_y = gravity.y;
 
-  if (water_y != FLT_MAX) {
-    b2BodyDef waterDef;
-    waterDef.userData.type = BODY_WATER;
-    waterDef.position.Set(0.f, water_y * POINT_SCALE + (WATER_BOX_SIZE*0.5f));
-    b2PolygonShape waterBox;
-    waterBox.SetAsBox(WATER_BOX_SIZE*0.5f, WATER_BOX_SIZE*0.5f);
-    world->water = world->world.CreateBody(&waterDef);
-    b2FixtureDef fixDef;
-    fixDef.shape = &waterBox;
-    fixDef.isSensor = true;
-    fixDef.filter.categoryBits = CB_WATER;
-    world->water->CreateFixture(&fixDef);
-  }
+  world->water_line = water_y;
+  world->water_moved = false;
   if (map->header->collision) {
     b2BodyDef bodyDef;
     bodyDef.userData.type = BODY_GROUND;
@@ -130,7 +185,15 @@ world_t *world_new(map_t *map, float gravity_x, float gravity_y, float water_y)
     fix.filter.categoryBits = CB_GROUND;
     world_body_add_collision_fixtures(mapBody, fix, map->header->collision);
   }
-  world->world.SetContactListener(&contact_listener);
+  bool presolve = false;
+  FOREACH_ARRAY(cls, actor_classes) {
+    if (cls->contact_events & CE_PRESOLVE)
+      presolve = true;
+  }
+  if (presolve)
+    world->world.SetContactListener(&presolve_contact_listener);
+  else
+    world->world.SetContactListener(&contact_listener);
 #ifndef NDEBUG
   world_set_debug_draw(world);
 #endif
@@ -138,12 +201,22 @@ world_t *world_new(map_t *map, float gravity_x, float gravity_y, float water_y)
 }
 
 void world_tick(world_t *world) {
-  world->world.Step(1.0 / (float) FPS, 6, 2);
-  world->world.SetAutoClearForces(true);
-  world->world.SetAllowSleeping(true);
+  world->world.Step(1.0 / (float) FPS, world->velocity_iterations, world->position_iterations);
+  world_update_water(world);
+#ifndef NDEBUG
+  map_t *map = world->map;
+  if ((map->cheats & MC_PHYSICS_PROFILE) && map->frame_counter % FPS == 0) {
+    world_profile_t profile;
+    world_get_profile(world, &profile);
+    debugf("physics: step %.2fms collide %.2fms solve %.2fms toi %.2fms broadphase %.2fms,"
+        " %u bodies (%u awake), %u contacts, %" PRIu32 " bytes\n",
+        profile.step_ms, profile.collide_ms, profile.solve_ms, profile.solve_toi_ms, profile.broadphase_ms,
+        profile.bodies, profile.awake_bodies, profile.contacts, profile.alloc.bytes);
+  }
+#endif
 }
 
-void ContactListener::Handle(b2Contact *contact, const b2Manifold *old) {
+void ContactListener::Handle(b2Contact *contact, const b2Manifold *old, uint8_t event) {
   auto fixA = contact->GetFixtureA();
   auto fixB = contact->GetFixtureB();
   auto bodyA = fixA->GetBody();
@@ -159,7 +232,7 @@ void ContactListener::Handle(b2Contact *contact, const b2Manifold *old) {
     actor_t *a = bodyA->GetUserData().actor;
     switch (typeB) {
     case BODY_GROUND:
-      if (a->collider)
+      if (a->collider && (a->cls->contact_events & event))
         a->collider(a, fixA, NULL, fixB, contact, old);
       break;
     case BODY_ACTOR:
@@ -170,39 +243,12 @@ void ContactListener::Handle(b2Contact *contact, const b2Manifold *old) {
           SWAP(a, b);
           SWAP(fixA, fixB);
         }
-        if (a->collider)
+        if (a->collider && (a->cls->contact_events & event))
           a->collider(a, fixA, b, fixB, contact, old);
-        if (b->collider)
+        if (b->collider && (b->cls->contact_events & event))
           b->collider(b, fixB, a, fixA, contact, old);
       }
       break;
-    case BODY_WATER:
-      if (!fixA->IsSensor()) {
-        if (contact->IsTouching()) {
-          if (!(a->flags & AF_UNDERWATER)) {
-            if (bodyA->GetLinearVelocity().y > POINT_SCALE) {
-              map_t *map = world_body_get_map(bodyB);
-              particle_spawn_splash(map, bodyA->GetWorldCenter().x * INV_POINT_SCALE);
-              actor_play_fx(a, SFX_SPLASH, 1);
-            }
-            a->flags |= AF_UNDERWATER;
-            bodyA->SetAngularDamping(bodyA->GetAngularDamping() + WATER_DAMPING);
-            bodyA->SetLinearDamping(bodyA->GetLinearDamping() + WATER_DAMPING);
-          }
-        } else if (a->flags & AF_UNDERWATER) {
-          if (bodyA->GetLinearVelocity().y < -POINT_SCALE) {
-            map_t *map = world_body_get_map(bodyB);
-            particle_spawn_splash(map, bodyA->GetWorldCenter().x * INV_POINT_SCALE);
-            actor_play_fx(a, SFX_SPLASH, 1);
-          }
-          a->flags &= ~AF_UNDERWATER;
-          bodyA->SetAngularDamping(bodyA->GetAngularDamping() - WATER_DAMPING);
-          bodyA->SetLinearDamping(bodyA->GetLinearDamping() - WATER_DAMPING);
-        }
-      }
-      if (a->collider)
-        a->collider(a, fixA, NULL, fixB, contact, old);
-      break;
     default:
       break;
     }
@@ -211,15 +257,177 @@ void ContactListener::Handle(b2Contact *contact, const b2Manifold *old) {
 
 void world_destroy(world_t *world) {
   world->world.~b2World();
-  world->water = nullptr;
+#ifndef NDEBUG
+  world_alloc_stats_t *stats = &world->arena.stats;
+  debugf("physics memory: %" PRIu32 " bytes peak, %" PRIu32 " allocations, %" PRIu32 " bytes arena, %" PRIu32 " bytes leaked\n",
+      stats->peak_bytes, stats->total_allocs, stats->arena_bytes, stats->bytes);
+#endif
+  // the pools go in one go, anything still in them is garbage
+  world_arena_block_t *block, *next;
+  SLIST_FOREACH_SAFE(block, &world->arena.blocks, entry, next)
+    free(block);
+  SLIST_FOREACH_SAFE(block, &world->arena.chunks, entry, next)
+    free(block);
+  world_arena = NULL;
   free(world);
 }
 
+void world_get_alloc_stats(world_t *world, world_alloc_stats_t *stats) {
+  *stats = world->arena.stats;
+}
+
+#ifndef NDEBUG
+void world_get_profile(world_t *world, world_profile_t *profile) {
+  const b2Profile &b2profile = world->world.GetProfile();
+  profile->step_ms = b2profile.step;
+  profile->collide_ms = b2profile.collide;
+  profile->solve_ms = b2profile.solve;
+  profile->solve_toi_ms = b2profile.solveTOI;
+  profile->broadphase_ms = b2profile.broadphase;
+  profile->bodies = world->world.GetBodyCount();
+  profile->contacts = world->world.GetContactCount();
+  profile->awake_bodies = 0;
+  for (b2Body *body = world->world.GetBodyList(); body; body = body->GetNext()) {
+    if (body->IsAwake())
+      profile->awake_bodies++;
+  }
+  profile->velocity_iterations = world->velocity_iterations;
+  profile->position_iterations = world->position_iterations;
+  world_get_alloc_stats(world, &profile->alloc);
+}
+
+// Box2D only times its profile on Windows, Linux and macOS and b2Timer has
+// no members anywhere else, so keep the start times here by instance. These
+// replace b2_timer.o from libbox2d.a, release builds keep its stubs
+#define WORLD_TIMER_SLOTS 16
+
+static struct {
+  const b2Timer *timer;
+  uint32_t start;
+} world_timers[WORLD_TIMER_SLOTS];
+
+// timers live on Box2D's stack, the same few addresses come back every step
+static uint32_t *world_timer_start(const b2Timer *timer) {
+  FOREACH_ARRAY(slot, world_timers) {
+    if (slot->timer == timer)
+      return &slot->start;
+    if (!slot->timer) {
+      slot->timer = timer;
+      return &slot->start;
+    }
+  }
+  assertf(0, "more than %d live b2Timers", WORLD_TIMER_SLOTS);
+  return NULL;
+}
+
+b2Timer::b2Timer() {
+  Reset();
+}
+
+void b2Timer::Reset() {
+  *world_timer_start(this) = get_ticks();
+}
+
+float b2Timer::GetMilliseconds() const {
+  return (get_ticks() - *world_timer_start(this)) * (1000.f / TICKS_PER_SECOND);
+}
+#endif
+
+// ********** ALLOCATOR **********
+
+static uint16_t world_alloc_class(int32 size) {
+  uint16_t size_class = 0;
+  while (size_class < WORLD_ALLOC_CLASSES && (WORLD_ALLOC_MIN_SIZE << size_class) < size)
+    size_class++;
+  if (size_class < WORLD_ALLOC_CLASSES)
+    return size_class;
+  return size <= WORLD_ALLOC_CHUNK_SIZE ? WORLD_ALLOC_CHUNK : WORLD_ALLOC_LARGE;
+}
+
+static void *world_arena_bump(world_arena_t *arena, uint32_t size) {
+  world_arena_block_t *block = SLIST_FIRST(&arena->blocks);
+  if (!block || block->used + size > WORLD_ARENA_BLOCK_SIZE) {
+    block = static_cast<world_arena_block_t *>(malloc(sizeof(world_arena_block_t) + WORLD_ARENA_BLOCK_SIZE));
+    assertf(block != NULL, "out of memory");
+    block->used = 0;
+    SLIST_INSERT_HEAD(&arena->blocks, block, entry);
+    arena->stats.arena_bytes += WORLD_ARENA_BLOCK_SIZE;
+  }
+  void *ptr = &block->data[block->used];
+  block->used += size;
+  return ptr;
+}
+
+static void *world_arena_chunk(world_arena_t *arena) {
+  uint32_t size = sizeof(world_alloc_header_t) + WORLD_ALLOC_CHUNK_SIZE;
+  world_arena_block_t *block = static_cast<world_arena_block_t *>(malloc(sizeof(world_arena_block_t) + size));
+  assertf(block != NULL, "out of memory");
+  block->used = size;
+  SLIST_INSERT_HEAD(&arena->chunks, block, entry);
+  arena->stats.arena_bytes += size;
+  return block->data;
+}
+
+void *world_b2_alloc(int32 size) {
+  world_arena_t *arena = world_arena;
+  uint16_t size_class = world_alloc_class(size);
+  world_alloc_header_t *header;
+
+  if (!arena || size_class == WORLD_ALLOC_LARGE) {
+    header = static_cast<world_alloc_header_t *>(malloc(sizeof *header + size));
+    assertf(header != NULL, "out of memory");
+    if (arena)
+      arena->stats.large_bytes += size;
+  } else if (!SLIST_EMPTY(&arena->free_lists[size_class])) {
+    header = reinterpret_cast<world_alloc_header_t *>(SLIST_FIRST(&arena->free_lists[size_class]));
+    SLIST_REMOVE_HEAD(&arena->free_lists[size_class], entry);
+  } else if (size_class == WORLD_ALLOC_CHUNK) {
+    header = static_cast<world_alloc_header_t *>(world_arena_chunk(arena));
+  } else {
+    header = static_cast<world_alloc_header_t *>(
+        world_arena_bump(arena, sizeof *header + (WORLD_ALLOC_MIN_SIZE << size_class)));
+  }
+
+  header->size_class = size_class;
+  header->size = size;
+  header->counted = arena != NULL;
+  if (arena) {
+    arena->stats.bytes += size;
+    arena->stats.peak_bytes = MAX(arena->stats.peak_bytes, arena->stats.bytes);
+    arena->stats.allocs++;
+    arena->stats.total_allocs++;
+  }
+  return &header[1];
+}
+
+void world_b2_free(void *mem) {
+  if (!mem)
+    return;
+  world_arena_t *arena = world_arena;
+  world_alloc_header_t *header = static_cast<world_alloc_header_t *>(mem) - 1;
+  if (header->counted && arena) {
+    arena->stats.bytes -= header->size;
+    arena->stats.allocs--;
+  }
+  if (header->size_class == WORLD_ALLOC_LARGE) {
+    if (header->counted && arena)
+      arena->stats.large_bytes -= header->size;
+    free(header);
+  } else {
+    assertf(arena != NULL, "pooled Box2D block freed without a world");
+    uint16_t size_class = header->size_class;
+    world_free_t *block = reinterpret_cast<world_free_t *>(header);
+    SLIST_INSERT_HEAD(&arena->free_lists[size_class], block, entry);
+  }
+}
+
 struct QueryCallback : public b2QueryCallback {
   world_actor_func_t func;
   const irect2_t *rect;
   void *arg;
   bool ReportFixture(b2Fixture *fix) override {
+    if (!fix->GetUserData().active)
+      return true;
     auto userdata = fix->GetBody()->GetUserData();
     if (userdata.type == BODY_ACTOR)
       return this->func(userdata.actor, this->rect, arg);
@@ -257,11 +465,8 @@ void world_link_actor(world_t *world, actor_t *actor, float x, float y, float an
     bodyDef.angle = angle;
     bodyDef.fixedRotation = !(flags & AF_ROTATES);
     actor->body = world->world.CreateBody(&bodyDef);
-    if (y > world->map->water_line && !(actor->flags & AF_UNDERWATER)) {
-      actor->flags |= AF_UNDERWATER;
-      actor->body->SetAngularDamping(actor->body->GetAngularDamping() + WATER_DAMPING);
-      actor->body->SetLinearDamping(actor->body->GetLinearDamping() + WATER_DAMPING);
-    }
+    if (y > world->water_line)
+      world_set_actor_underwater(actor, true);
   }
   world_update_actor_collision(actor);
 }
@@ -275,6 +480,7 @@ static void world_body_add_collision_fixtures(body_t *body, b2FixtureDef fix, co
     fix.isSensor = sensor || (collision->flags & CF_SENSOR) != 0;
     fix.filter.categoryBits = (collision->flags & CF_INTERACTIVE) ? CB_INTERACTIVE : categoryBits;
     fix.userData.id = collision->id;
+    fix.userData.flags = collision->flags;
     switch (collision->type) {
     case COLL_AABB:
       {
@@ -421,6 +627,35 @@ float world_get_actor_angle(actor_t *actor) {
   return actor->body->GetAngle();
 }
 
+// union of the active fixtures in pixels, or just the position without any
+// false for disabled bodies and ones with no active fixtures, the physics
+// query never returned those
+bool world_get_actor_bounds(actor_t *actor, irect2_t *bounds) {
+  if (!actor->body->IsEnabled())
+    return false;
+  b2AABB aabb;
+  bool empty = true;
+  for (b2Fixture *fix = actor->body->GetFixtureList(); fix; fix = fix->GetNext()) {
+    if (!fix->GetUserData().active)
+      continue;
+    int32 children = fix->GetShape()->GetChildCount();
+    for (int32 child = 0; child < children; child++) {
+      if (empty)
+        aabb = fix->GetAABB(child);
+      else
+        aabb.Combine(fix->GetAABB(child));
+      empty = false;
+    }
+  }
+  if (empty)
+    return false;
+  bounds->x0 = floorf(aabb.lowerBound.x * INV_POINT_SCALE);
+  bounds->y0 = floorf(aabb.lowerBound.y * INV_POINT_SCALE);
+  bounds->x1 = ceilf(aabb.upperBound.x * INV_POINT_SCALE);
+  bounds->y1 = ceilf(aabb.upperBound.y * INV_POINT_SCALE);
+  return true;
+}
+
 void world_set_actor_position(actor_t *actor, float x, float y) {
   actor->body->SetTransform(POINT_SCALE * b2Vec2(x, y), actor->body->GetAngle());
 }
@@ -438,15 +673,20 @@ void world_set_actor_transform(actor_t *actor, float x, float y, float angle) {
   actor->body->SetTransform(POINT_SCALE * b2Vec2(x, y), angle);
 }
 
-void world_update_actor_state(actor_t *actor) {
-  uint32_t flags = actor->flags;
-  b2Body *body = actor->body;
+static b2Filter world_actor_filter(actor_t *actor) {
   b2Filter filter;
-
-  filter.categoryBits = (flags & AF_NOCOLLIDE) ? 0 : actor->cls->category_bits;
+  filter.categoryBits = (actor->flags & AF_NOCOLLIDE) ? 0 : actor->cls->category_bits;
   filter.maskBits = actor->cls->category_mask;
   if (!filter.maskBits)
     filter.maskBits = CB_ALL;
+  return filter;
+}
+
+void world_update_actor_state(actor_t *actor) {
+  uint32_t flags = actor->flags;
+  b2Body *body = actor->body;
+  b2Filter filter = world_actor_filter(actor);
+
   body->SetType(
       (flags & AF_KINEMATIC)
       ? b2_kinematicBody
@@ -454,35 +694,116 @@ void world_update_actor_state(actor_t *actor) {
   body->SetGravityScale((flags & AF_GRAVITY) ? 1.f : 0.f);
   body->SetFixedRotation(!(flags & AF_ROTATES));
   for (b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+    if (!fixture->GetUserData().active)
+      continue;
     fixture->SetSensor(!(flags & AF_SOLID));
     fixture->SetFilterData(filter);
   }
 }
 
+// fixtures stay on the body after the actor switches to another collision
+// stream, filtered out and massless, so animating between frames only swaps
+// filter data instead of reallocating shapes and broadphase proxies
 void world_update_actor_collision(actor_t *actor) {
-  {
-    b2Fixture *fixture, *next;
-    for (fixture = actor->body->GetFixtureList(); fixture; fixture = next) {
-      next = fixture->GetNext();
-      actor->body->DestroyFixture(fixture);
+  b2Body *body = actor->body;
+  bool owned = (actor->flags & AF_COLLISION_OWNED) != 0;
+  bool cached = false;
+  bool changed = false;
+  b2Filter filter = world_actor_filter(actor);
+  b2Filter inactive_filter;
+  inactive_filter.categoryBits = 0;
+  inactive_filter.maskBits = 0;
+
+  b2Fixture *fixture, *next;
+  for (fixture = body->GetFixtureList(); fixture; fixture = next) {
+    next = fixture->GetNext();
+    auto &userdata = fixture->GetUserData();
+    // owned streams are freed and their addresses reused, never cache them
+    if (owned) {
+      body->DestroyFixture(fixture);
+    } else if (userdata.group == actor->collision) {
+      cached = true;
+      if (!userdata.active) {
+        b2Filter active_filter = filter;
+        if (userdata.flags & CF_INTERACTIVE)
+          active_filter.categoryBits = CB_INTERACTIVE;
+        userdata.active = true;
+        fixture->SetSensor(!(actor->flags & AF_SOLID) || (userdata.flags & CF_SENSOR));
+        fixture->SetFilterData(active_filter);
+        fixture->SetDensity(actor->cls->density);
+        changed = true;
+      }
+    } else if (userdata.active) {
+      userdata.active = false;
+      fixture->SetFilterData(inactive_filter);
+      fixture->SetDensity(0.f);
+      changed = true;
     }
   }
+  if (changed)
+    body->ResetMassData();
+  if (cached)
+    return;
 
   b2FixtureDef fix;
 
   fix.density = actor->cls->density;
   fix.isSensor = !(actor->flags & AF_SOLID);
-  fix.filter.categoryBits = (actor->flags & AF_NOCOLLIDE) ? 0 : actor->cls->category_bits;
-  fix.filter.maskBits = actor->cls->category_mask;
-  if (!fix.filter.maskBits)
-    fix.filter.maskBits = CB_ALL;
+  fix.filter = filter;
+  fix.userData.group = owned ? nullptr : actor->collision;
 
-  world_body_add_collision_fixtures(actor->body, fix, actor->collision);
+  world_body_add_collision_fixtures(body, fix, actor->collision);
 }
 
 void world_move_water(world_t *world, float y) {
-  if (world->water)
-    world->water->SetTransform(b2Vec2(0.f, y * POINT_SCALE + (WATER_BOX_SIZE*0.5f)), 0.f);
+  world->water_line = y;
+  world->water_moved = true;
+}
+
+static void world_set_actor_underwater(actor_t *actor, bool underwater) {
+  if (underwater == !!(actor->flags & AF_UNDERWATER))
+    return;
+  float damping = underwater ? WATER_DAMPING : -WATER_DAMPING;
+  actor->flags ^= AF_UNDERWATER;
+  actor->body->SetAngularDamping(actor->body->GetAngularDamping() + damping);
+  actor->body->SetLinearDamping(actor->body->GetLinearDamping() + damping);
+}
+
+// water is a flat line, so instead of a sensor body every dynamic actor's
+// solid fixtures are tested against it once per step. sleeping bodies can't
+// cross it unless the line itself moved
+static void world_update_water(world_t *world) {
+  if (world->water_line == FLT_MAX)
+    return;
+  bool moved = world->water_moved;
+  world->water_moved = false;
+  float water_y = world->water_line * POINT_SCALE;
+  for (b2Body *body = world->world.GetBodyList(); body; body = body->GetNext()) {
+    if (body->GetType() != b2_dynamicBody || body->GetUserData().type != BODY_ACTOR || !body->IsEnabled())
+      continue;
+    if (!moved && !body->IsAwake())
+      continue;
+    actor_t *actor = body->GetUserData().actor;
+    bool touching = false;
+    for (b2Fixture *fix = body->GetFixtureList(); fix; fix = fix->GetNext()) {
+      // AF_NOCOLLIDE clears the category, those actors don't touch water either
+      const b2Filter &filter = fix->GetFilterData();
+      if (fix->IsSensor() || !fix->GetUserData().active || !filter.categoryBits || !(filter.maskBits & CB_WATER))
+        continue;
+      if (fix->GetAABB(0).upperBound.y > water_y) {
+        touching = true;
+        break;
+      }
+    }
+    if (touching == !!(actor->flags & AF_UNDERWATER))
+      continue;
+    float vel = body->GetLinearVelocity().y;
+    if (touching ? vel > POINT_SCALE : vel < -POINT_SCALE) {
+      particle_spawn_splash(world->map, body->GetWorldCenter().x * INV_POINT_SCALE);
+      actor_play_fx(actor, SFX_SPLASH, 1);
+    }
+    world_set_actor_underwater(actor, touching);
+  }
 }
 
 void world_set_gravity(world_t *world, float gravity_x, float gravity_y) {
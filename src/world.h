@@ -31,7 +31,7 @@ typedef struct b2Contact contact_t;
 typedef struct b2Fixture fixture_t;
 typedef struct b2Manifold manifold_t;
 
-typedef struct {
+typedef struct collision_s {
   uint16_t type;
   uint16_t flags;
   uint32_t id;
@@ -44,9 +44,39 @@ union world_position_u {
   struct { float x, y; };
 };
 
+// Box2D memory of the live world
+typedef struct {
+  uint32_t bytes; // requested by Box2D and not freed yet
+  uint32_t peak_bytes;
+  uint32_t allocs;
+  uint32_t total_allocs;
+  uint32_t arena_bytes; // reserved for the size class and chunk pools
+  uint32_t large_bytes; // live allocations bigger than a block allocator chunk
+} world_alloc_stats_t;
+
 world_t *world_new(map_t *map, float gravity_x, float gravity_y, float water_y);
 void world_tick(world_t *world);
 void world_destroy(world_t *world);
+void world_get_alloc_stats(world_t *world, world_alloc_stats_t *stats);
+
+#ifndef NDEBUG
+typedef struct {
+  float step_ms;
+  float collide_ms;
+  float solve_ms;
+  float solve_toi_ms;
+  float broadphase_ms;
+  uint16_t bodies;
+  uint16_t awake_bodies;
+  uint16_t contacts;
+  uint8_t velocity_iterations;
+  uint8_t position_iterations;
+  world_alloc_stats_t alloc;
+} world_profile_t;
+
+// timings of the last step, C up toggles the overlay and a log every second
+void world_get_profile(world_t *world, world_profile_t *profile);
+#endif
 
 typedef bool (*world_actor_func_t)(actor_t *, const irect2_t *rect, void *);
 
@@ -57,6 +87,7 @@ void world_link_actor(world_t *world, actor_t *actor, float x, float y, float an
 world_position_t _world_get_actor_position(actor_t *actor);
 world_position_t _world_get_actor_center(actor_t *actor);
 float world_get_actor_angle(actor_t *actor);
+bool world_get_actor_bounds(actor_t *actor, irect2_t *bounds);
 void world_set_actor_position(actor_t *actor, float x, float y);
 void world_set_actor_position_centered(actor_t *actor, float x, float y);
 void world_set_actor_angle(actor_t *actor, float angle);
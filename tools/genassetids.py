@@ -8,6 +8,7 @@ parser.add_argument('output', type=Path)
 parser.add_argument('name', type=str)
 parser.add_argument('filenames', type=Path, nargs='+')
 parser.add_argument('-H', '--header', action='store_true')
+parser.add_argument('-N', '--native-scripts', action='store_true', help='write the table of scripts compiled by maptool -c')
 
 args = parser.parse_args()
 
@@ -16,7 +17,17 @@ name_upper = args.name.upper()
 
 f = open(args.output, 'a')
 
-if args.header:
+if args.native_scripts:
+    names = [filename.stem.replace('-', '_') for filename in args.filenames]
+    f.write('#include "assets.h"\n#include "script.h"\n\n')
+    for name in names:
+        f.write(f'extern const script_native_table_t script_natives_{name};\n')
+    f.write(f'\nconst script_native_table_t *const script_native_tables[NUM_{name_upper}] = {{\n')
+    f.write('  (void *) 0,\n')
+    for name in names:
+        f.write(f'  &script_natives_{name},\n')
+    f.write('};\n')
+elif args.header:
     f.write('typedef enum {\n')
     f.write(f'  {name_upper}_NONE,\n')
     for filename in args.filenames:
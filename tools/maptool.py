@@ -1,18 +1,19 @@
 #!/usr/bin/env python3
 
-import array, argparse, mapscriptparser, math, numpy, os, pyclipr, pytiled_parser, re, sys, util
+import array, argparse, mapscriptparser, math, numpy, os, pyclipr, pytiled_parser, re, scriptopt, sys, util
 from PIL import Image
 from mapscriptparser import ScriptCommand, ScriptColor, ScriptFunc, \
                             ScriptFuncArgs, ScriptIdent, ScriptValue, \
                             script_parser, inline_script_parser
 from pathlib import Path
 from scriptcmds import SCRIPT_COMMANDS
-from struct import pack
+from struct import unpack_from
 from types import NoneType
 from typing import Optional
-from util import err
+from util import err, pack
 
 DEFAULT_GRAVITY = (0, 1000)
+DEFAULT_ITERATIONS = (6, 2) # Box2D velocity and position iterations
 
 IDENT_RE = re.compile(r"[_a-zA-Z][_a-zA-Z0-9]*")
 
@@ -26,6 +27,8 @@ AF_CUR_PLAYER = (1<<29)
 AF_FLIPX  = (1<<28)
 AF_FLIPY  = (1<<27)
 AF_FLIPD  = (1<<26)
+# asset_kind_t in cache.h
+ASSET_KINDS = {'gfx': 1, 'tileset': 2, 'model': 3, 'sfx': 4, 'actor': 5}
 
 parser = argparse.ArgumentParser(prog='Tile Definition Builder Tool')
 parser.add_argument('filename', type=Path)
@@ -35,8 +38,13 @@ parser.add_argument('-s', '--script-ops', type=Path, required=True)
 parser.add_argument('-o', '--output', type=Path, default=Path('.'))
 parser.add_argument('-v', '--verbose', action='store_true')
 parser.add_argument('-S', '--svg-dump', action='store_true')
+parser.add_argument('-O', '--no-optimize', action='store_true', help='emit scripts op for op')
+parser.add_argument('-c', '--native-scripts', type=Path, help='directory to write scripts compiled to C')
+parser.add_argument('-L', '--little-endian', action='store_true', help='write little endian data for the host build')
 
 args = parser.parse_args()
+if args.little_endian:
+    util.BYTE_ORDER = '<'
 #args.svg_dump = True
 
 def pack_color(c: Optional[pytiled_parser.Color]) -> int:
@@ -210,7 +218,7 @@ def process_map(path: Path):
                             tid |= MAP_FLIPD
                         cdata.append(tid)
                 coord = (int(chunk.coordinates.x) >> 4, int(chunk.coordinates.y) >> 4)
-                c = chunks.setdefault(coord, [[], [], None])
+                c = chunks.setdefault(coord, [[], [], None, []])
                 if c[2] is None and cur_layer == 3:
                     c[2] = len(c[0])
                 c[0].append(cdata)
@@ -291,13 +299,30 @@ def process_map(path: Path):
                         end = (int(obj.coordinates.x + obj.size.width) // 256, int(obj.coordinates.y + obj.size.height) // 256)
                         for y in range(start[1], end[1]+1):
                             for x in range(start[0], end[0]+1):
-                                c = chunks.setdefault((x, y), [[], [], None])
+                                c = chunks.setdefault((x, y), [[], [], None, []])
                                 c[1].append((cur_layer, obj))
 
+    # optimize scripts
+    ops_before = sum(scriptopt.op_count(script) for script in scripts)
+    if not args.no_optimize:
+        started = set(trigger.properties['trigger'] for trigger in triggers)
+        started.add(startup_script)
+        scriptopt.ScriptOptimizer(scripts, started).optimize()
+    ops_after = sum(scriptopt.op_count(script) for script in scripts)
+    print(f'    {path.name}: {ops_before} script ops, {ops_after} after optimizing')
+
     # compile scripts
     compiled_scripts: list[bytes] = []
+    native_scripts: list[tuple[list[tuple[str, int]], bytes]] = []
     string_pool: list[str] = []
     script_actors: list[bytes] = []
+    script_actor_refs: set[int] = set()
+    # every asset the map can load, actor types are expanded to their class's
+    # assets by map_load
+    manifest: set[tuple[int, int]] = set()
+    def use_asset(kind: str, id: int):
+        if id:
+            manifest.add((ASSET_KINDS[kind], id))
     actor_count = len(actors) + len(triggers)
 
     def scripterr(func, tok, msg):
@@ -310,7 +335,9 @@ def process_map(path: Path):
 
     for script in scripts:
         script_buf = util.DataPool()
+        script_native_ops: list[tuple[str, int]] = []
         if script.singleton:
+            script_native_ops.append(('OP_SINGLETON', 0))
             script_buf.write(pack('>I', script_ops.value('OP_SINGLETON')))
         if len(script.commands) == 0 or script.commands[-1].name not in ['jump', 'exit', 'return']:
             script.commands.append(ScriptCommand((-1, -1), 'return'))
@@ -321,6 +348,7 @@ def process_map(path: Path):
             if cmd_def is None:
                 scripterr(script, cmd, f'unknown script command {command}')
             cmd_id, arg_defs = cmd_def
+            script_native_ops.append((cmd_id, script_buf.data.tell()))
             script_buf.write(pack('>I', script_ops.value(cmd_id)))
             buf = script_buf
             if command.name == 'spawn_actor':
@@ -421,6 +449,7 @@ def process_map(path: Path):
                             index = script_objs.get('actor', value.value.value)
                         except Exception as e:
                             scripterr(script, value, e)
+                        script_actor_refs.add(index)
                     buf.write(pack('>I', index))
                 elif typ == 'target':
                     checkargtype(script, value, 'identifier or @caller or @camera or null', ScriptIdent, '@caller', '@camera', NoneType)
@@ -437,6 +466,8 @@ def process_map(path: Path):
                             if index is None:
                                 scripterr(script, value, f'no such target `{value.value}`')
                             index = -(index + 1)
+                        else:
+                            script_actor_refs.add(index)
                     buf.write(pack('>I', index))
                 elif typ == 'float':
                     checkargtype(script, value, 'float', float, int)
@@ -465,6 +496,7 @@ def process_map(path: Path):
                             sfx_id = assets.index('sfx', '../sounds/' + value.value)
                         except Exception as e:
                             scripterr(script, value, e)
+                    use_asset('sfx', sfx_id)
                     buf.write(pack('>I', sfx_id))
                 elif typ == 'actortype':
                     checkargtype(script, value, 'actor type identifier', ScriptIdent)
@@ -472,6 +504,7 @@ def process_map(path: Path):
                         actor_type_id = actor_types.value(value.value.value)
                     except ValueError:
                         scripterr(script, value, f'unknown actor type `{value.value.value}`')
+                    use_asset('actor', actor_type_id)
                     buf.write(pack('>I', actor_type_id))
                 elif typ == 'newtarget':
                     checkargtype(script, value, 'identifier or null', ScriptIdent, NoneType)
@@ -495,6 +528,8 @@ def process_map(path: Path):
                         tiles_id = assets.index('tileset', value.value)
                     except Exception as e:
                         scripterr(script, value, e)
+                    use_asset('gfx', gfx_id)
+                    use_asset('tileset', tiles_id)
                     buf.write(pack('>HH', gfx_id, tiles_id))
                 else:
                     err(f'unknown type in command definition: {typ}')
@@ -509,11 +544,16 @@ def process_map(path: Path):
                     script_actors.append(actor_bytes)
                 script_buf.write(pack('>I', actor_count + index))
 
+        native_scripts.append((script_native_ops, script_buf.data.getvalue()))
         compiled_scripts.append(script_buf.finish())
 
     # misc map props
     gravity_x = map_props.get('gravity_x') or DEFAULT_GRAVITY[0]
     gravity_y = map_props.get('gravity_y') or map_props.get('gravity') or DEFAULT_GRAVITY[1]
+    velocity_iterations = map_props.get('velocity_iterations') or DEFAULT_ITERATIONS[0]
+    position_iterations = map_props.get('position_iterations') or DEFAULT_ITERATIONS[1]
+    if not 0 < velocity_iterations < 256 or not 0 < position_iterations < 256:
+        err('solver iterations must be between 1 and 255')
     music_id = 0
     music = map_props.get('music')
     if music is not None:
@@ -527,6 +567,51 @@ def process_map(path: Path):
         else:
             camera_start = (214, 120)
 
+    # SPAWN BUCKETS
+    # the player and actors named by scripts spawn on load, all other initial
+    # spawns are listed in the chunks they cover and spawn when those come near
+    # the camera
+    map_width = tmap.map_size.width >> 4
+    map_height = tmap.map_size.height >> 4
+
+    def spawn_chunks(obj: pytiled_parser.tiled_object.TiledObject, x: int, y: int) -> list[tuple[int, int]] | None:
+        if isinstance(obj, (pytiled_parser.tiled_object.Polygon, pytiled_parser.tiled_object.Polyline)):
+            x0 = x + int(min(p.x for p in obj.points))
+            y0 = y + int(min(p.y for p in obj.points))
+            x1 = x + int(max(p.x for p in obj.points))
+            y1 = y + int(max(p.y for p in obj.points))
+        else:
+            x0, y0 = x, y
+            x1 = x + int(obj.size.width)
+            y1 = y + int(obj.size.height)
+        cx0, cy0, cx1, cy1 = x0 >> 8, y0 >> 8, x1 >> 8, y1 >> 8
+        if cx0 < lower_x or cy0 < lower_y or cx1 >= lower_x + map_width or cy1 >= lower_y + map_height:
+            return None
+        return [(cx, cy) for cy in range(cy0, cy1 + 1) for cx in range(cx0, cx1 + 1)]
+
+    eager_spawns = []
+    lazy_spawns = []
+    for tile in actors:
+        actor_id = script_objs.get('actor', tile.name or None) or 0
+        coverage = None
+        if tile.properties.get('player') != True and actor_id not in script_actor_refs:
+            coverage = spawn_chunks(tile,
+                                    int(actor_layer.offset.x + tile.coordinates.x),
+                                    int(actor_layer.offset.y + tile.coordinates.y))
+        (eager_spawns if coverage is None else lazy_spawns).append(('actor', tile, coverage))
+    for trigger in triggers:
+        trigger_id = script_objs.get('actor', trigger.name or None) or 0
+        coverage = None
+        if trigger_id not in script_actor_refs:
+            coverage = spawn_chunks(trigger, int(trigger.coordinates.x), int(trigger.coordinates.y))
+        (eager_spawns if coverage is None else lazy_spawns).append(('trigger', trigger, coverage))
+    init_spawns = eager_spawns + lazy_spawns
+    for index, (_, _, coverage) in enumerate(init_spawns):
+        for coord in (coverage or []):
+            chunks.setdefault(coord, [[], [], None, []])[3].append(index)
+    if args.verbose:
+        print('Spawns', len(eager_spawns), 'eager', len(lazy_spawns), 'lazy')
+
     # begin writing
     if args.verbose:
         print('Map Offset', lower_x, lower_y,
@@ -534,12 +619,12 @@ def process_map(path: Path):
 
     # HEADER
     buf = util.DataPool(b'TMAP')
-    buf.write(pack('>HHHHhhHHHHHH',
+    buf.write(pack('>HHHHhhHHHHHHHBB',
                    len(tid_map), len(bgs), len(waypoints), len(scripts),
-                   lower_x, lower_y,
-                   tmap.map_size.width >> 4, tmap.map_size.height >> 4,
+                   lower_x, lower_y, map_width, map_height,
                    len(chunks), len(string_pool),
-                   actor_count, actor_count + len(script_actors)))
+                   actor_count, actor_count + len(script_actors),
+                   len(eager_spawns), velocity_iterations, position_iterations))
     actor_buf = buf.write_ref(-3)
     waypoint_buf = buf.write_ref(-4)
     collision_buf = buf.write_ref(-4)
@@ -549,6 +634,7 @@ def process_map(path: Path):
                    int(tmap.parallax_origin.x), int(tmap.parallax_origin.y),
                    camera_start[0], camera_start[1],
                    water_line, water_color, gravity_x, gravity_y))
+    manifest_buf = buf.write_ref(-6)
 
     # TILESETS
     for firstgid, firsttid in tid_map.items():
@@ -557,6 +643,7 @@ def process_map(path: Path):
         xmask = (tiles.image_width >> 4) - 1
         yshift = int(math.log2(xmask + 1))
         image_id = assets.index('gfx', tiles.image)
+        use_asset('gfx', image_id)
         if args.verbose:
             print('Tileset', firstgid, '=> (', firsttid, endtid, '], count', tiles.tile_count, ',',  tiles.image)
         buf.write(pack('>HHBBxxI', firsttid, endtid, xmask, yshift, image_id))
@@ -574,6 +661,8 @@ def process_map(path: Path):
             anim = assets.index('tileset', anim)
         else:
             anim = 0
+        use_asset('gfx', image_id)
+        use_asset('tileset', anim)
         buf.write(pack('>ffffffIIB??xIIIff',
                        layer.offset.x, layer.offset.y,
                        autoscroll_x, autoscroll_y,
@@ -583,14 +672,20 @@ def process_map(path: Path):
                        image_id, anim, 0, 0, 1))
 
     # CHUNKS
-    for (x, y), (layers, props, fg_layer) in chunks.items():
+    for (x, y), (layers, props, fg_layer, spawns) in chunks.items():
         if fg_layer is None:
             fg_layer = len(layers)
         chunk_buf = buf.write_ref(0)
         chunk_buf.write(pack('>hhiibbH', x, y, x << 8, y << 8, len(layers), fg_layer, len(props)))
         props_buf = chunk_buf.write_ref(-1)
+        spawns_buf = chunk_buf.write_ref(-1)
+        chunk_buf.write(pack('>H?x', len(spawns), False))
+        for index in spawns:
+            spawns_buf.write(pack('>H', index))
+        if len(spawns) & 1:
+            spawns_buf.write(pack('>H', 0xffff))
         if args.verbose:
-            print('Chunk at (', x, y, ') with', len(layers), 'layers')
+            print('Chunk at (', x, y, ') with', len(layers), 'layers', len(spawns), 'spawns')
         for layer, obj in reversed(props):
             prop_gid = (obj.gid & 0x0ffffff) - prop_tileset.firstgid
             tile = prop_tileset.tiles[prop_gid]
@@ -599,19 +694,22 @@ def process_map(path: Path):
                 anim = assets.index('tileset', os.path.join('..', anim))
             else:
                 anim = 0
+            image_id = assets.index('gfx', tile.image)
+            use_asset('gfx', image_id)
+            use_asset('tileset', anim)
             prop_buf = props_buf.write_ref(-2)
-            prop_buf.write(pack('>IiiIIIIIIIIIffI',
+            prop_buf.write(pack('>IiiIIIIIIIIIIffI',
                                 layer,
                                 int(obj.coordinates.x), int(obj.coordinates.y),
                                 int(obj.size.width), int(obj.size.height),
-                                assets.index('gfx', tile.image), anim,
-                                0, 0, 0, 0, 0, 0, 1, 0))
+                                image_id, anim,
+                                0, 0, 0, 0, 0, 0, 0, 1, 0))
             if args.verbose:
                 print('  Prop at layer', layer, obj.coordinates, tile.image)
         chunk_buf.write(pack('>I', 0))
         for layer in layers:
             a = array.array('H', layer)
-            if sys.byteorder == 'little':
+            if (sys.byteorder == 'little') != (util.BYTE_ORDER == '<'):
                 a.byteswap()
             chunk_buf.write(a.tobytes())
 
@@ -647,8 +745,9 @@ def process_map(path: Path):
         else:
             buf.write(pack('>I', 0))
 
-    for tile in actors:
+    def write_actor_spawn(tile: pytiled_parser.tiled_object.Tile):
         actor_type_id = actor_types.value(tile.properties['typename'])
+        use_asset('actor', actor_type_id)
         actor_id = script_objs.get('actor', tile.name or None) or 0
         x = int(actor_layer.offset.x + tile.coordinates.x)
         y = int(actor_layer.offset.y + tile.coordinates.y)
@@ -667,7 +766,7 @@ def process_map(path: Path):
         if args.verbose:
             print('Actor', tile.properties['typename'], 'at (', x, y, ') flags', hex(flags), 'id', actor_id)
 
-    for trigger in triggers:
+    def write_trigger_spawn(trigger: pytiled_parser.tiled_object.TiledObject):
         x = int(trigger.coordinates.x)
         y = int(trigger.coordinates.y)
         trigger_id = script_objs.get('actor', trigger.name or None) or 0
@@ -695,6 +794,12 @@ def process_map(path: Path):
         if args.verbose:
             print('Trigger', type(trigger), 'at (', x, y, ') flags', hex(flags))
 
+    for kind, obj, _ in init_spawns:
+        if kind == 'actor':
+            write_actor_spawn(obj)
+        else:
+            write_trigger_spawn(obj)
+
     # WAYPOINTS
     for obj in waypoints:
         next_point = (obj.properties or {}).get('next')
@@ -722,10 +827,109 @@ def process_map(path: Path):
     for text in string_pool:
         texts_buf.write_ref(-5).write(bytes(text, 'utf-8') + '\x00')
 
+    # MANIFEST
+    for kind, id in sorted(manifest):
+        manifest_buf.write(pack('>BxH', kind, id))
+    manifest_buf.write(pack('>BxH', 0, 0))
+    if args.verbose:
+        print('Manifest', len(manifest), 'assets')
+
     os.chdir(orig_dir)
     with open(args.output.joinpath(path.stem + '.map'), 'wb') as f:
         f.write(buf.finish())
 
+    if args.native_scripts:
+        args.native_scripts.mkdir(parents=True, exist_ok=True)
+        with open(args.native_scripts.joinpath(path.stem + '.c'), 'w') as f:
+            f.write(compile_native_scripts(path, native_scripts))
+
+# NATIVE SCRIPTS
+# every op becomes a case of a switch on state->resume, common ops are inlined
+# and the rest run through the interpreter one op at a time, calls hand the
+# script over to the interpreter since the return stack holds bytecode
+def compile_native_scripts(path: Path, scripts: list[tuple[list[tuple[str, int]], bytes]]) -> str:
+    name = path.stem.replace('-', '_')
+    def func(script_id: int) -> str:
+        return f'{name}_script_{script_id}'
+    def c_float(v: float) -> str:
+        return float.hex(v) + 'f'
+
+    out = [f'// generated by maptool from {path.name}\n', '#include "scriptnative.h"\n']
+    for script_id in range(len(scripts)):
+        out.append(f'static script_ret_t {func(script_id)}(map_t *map, script_state_t *state);')
+    out.append('')
+
+    for script_id, (ops, code) in enumerate(scripts):
+        out.append(f'static script_ret_t {func(script_id)}(map_t *map, script_state_t *state) {{')
+        out.append('  SCRIPT_NATIVE_BEGIN()')
+        for n, (op, offset) in enumerate(ops):
+            def arg(fmt: str, pos: int = 4):
+                return unpack_from(util.BYTE_ORDER + fmt, code, offset + pos)[0]
+            where = f'{n}, {script_id}, {offset}'
+            lines = []
+            if op == 'OP_NOOP':
+                pass
+            elif op == 'OP_EXIT' or op == 'OP_RET':
+                lines.append('return RET_EXIT;')
+            elif op == 'OP_JUMP':
+                target = arg('I')
+                lines.append(f'SCRIPT_NATIVE_JUMP({func(target)}, {target});')
+            elif op == 'OP_CALL':
+                lines.append(f'SCRIPT_NATIVE_HANDOFF({script_id}, {offset});')
+            elif op == 'OP_DELAY':
+                frames = arg('I')
+                if frames:
+                    lines.append(f'SCRIPT_NATIVE_DELAY({where}, {frames});')
+            elif op in ['OP_WAIT_STATE', 'OP_ACQUIRE_STATE']:
+                flags = arg('I')
+                lines.append(f'if (map->state_flags & {flags:#010x})')
+                lines.append(f'  SCRIPT_NATIVE_WAIT({where}, SW_STATE);')
+                if op == 'OP_ACQUIRE_STATE':
+                    lines.append(f'map->state_flags |= {flags:#010x};')
+            elif op == 'OP_RELEASE_STATE':
+                flags = arg('I')
+                lines.append(f'assertf(map->state_flags & {flags:#010x}, "state %08x released twice", {flags:#010x});')
+                lines.append(f'map->state_flags &= ~{flags:#010x};')
+                lines.append('script_notify(map, SW_STATE);')
+            elif op == 'OP_FORCE_STATE':
+                lines.append(f'map->state_flags |= {arg("I"):#010x};')
+            elif op == 'OP_SHOW_DIALOG' and arg('i', 8) in [0, -0x7fffffff]:
+                target = 'state->caller' if arg('i', 8) else 'NULL'
+                lines.append('if (map->dialog_text)')
+                lines.append(f'  SCRIPT_NATIVE_WAIT({where}, SW_DIALOG);')
+                lines.append(f'map_set_dialog(map, map->header->texts[{arg("I")}], {target});')
+            elif op == 'OP_WAIT_DIALOG':
+                lines.append('if (map->dialog_text)')
+                lines.append(f'  SCRIPT_NATIVE_WAIT({where}, SW_DIALOG);')
+            elif op == 'OP_SET_GRAVITY':
+                lines.append(f'world_set_gravity(map->world, {c_float(arg("f"))}, {c_float(arg("f", 8))});')
+            elif op == 'OP_CHANGE_MUSIC':
+                lines.append(f'sound_play_music({arg("I")}, {c_float(arg("f", 8))}, {arg("I", 12)});')
+            elif op == 'OP_EARTHQUAKE':
+                lines.append(f'map->quake_counter = MAX(map->quake_counter, {arg("I")}u);')
+                lines.append(f'map->quake_strength = MAX(map->quake_strength, {arg("I", 8)}u);')
+            elif op == 'OP_WAIT_EARTHQUAKE':
+                lines.append('if (map->quake_counter)')
+                lines.append(f'  SCRIPT_NATIVE_WAIT({where}, SW_EARTHQUAKE);')
+            else:
+                lines.append(f'SCRIPT_NATIVE_STEP({where});')
+            if n > 0:
+                out.append(f'  case {n}: // {op}')
+            else:
+                out[-1] += f' // {op}'
+            out += ['    ' + line for line in lines]
+        out.append('  SCRIPT_NATIVE_END()')
+        out.append('}\n')
+
+    if len(scripts) == 0:
+        out.append(f'const script_native_table_t script_natives_{name} = {{ 0, NULL }};')
+    else:
+        out.append(f'static const script_native_t {name}_scripts[] = {{')
+        out += [f'  {func(script_id)},' for script_id in range(len(scripts))]
+        out.append('};\n')
+        out.append(f'const script_native_table_t script_natives_{name} = {{ {len(scripts)}, {name}_scripts }};')
+    return '\n'.join(out) + '\n'
+
 def degrees_to_ang16(v: float | int) -> int:
     return min(round((v % 360) / 360 * 65536), 65535)
 
@@ -0,0 +1,123 @@
+from mapscriptparser import ScriptCommand, ScriptFunc, ScriptFuncArgs, ScriptIdent, ScriptValue
+
+TERMINATORS = ['jump', 'exit', 'return']
+INSTANCE_COMMANDS = ['wait', 'stop_one', 'stop']
+INLINE_MAX_COMMANDS = 4 # including the return that gets dropped
+MAX_PASSES = 8
+
+def op_count(script: ScriptFunc) -> int:
+    count = len(script.commands)
+    if script.singleton:
+        count += 1
+    if len(script.commands) == 0 or script.commands[-1].name not in TERMINATORS:
+        count += 1
+    return count
+
+def script_arg(command: ScriptCommand) -> str | None:
+    if len(command.args) == 1 and len(command.args.args) == 1 \
+            and isinstance(command.args.args[0].value, ScriptIdent):
+        return command.args.args[0].value.value
+    return None
+
+def int_arg(command: ScriptCommand) -> int | None:
+    if len(command.args) == 1 and len(command.args.args) == 1 \
+            and type(command.args.args[0].value) == int:
+        return command.args.args[0].value
+    return None
+
+def with_script_arg(command: ScriptCommand, name: str, cmd: str | None = None) -> ScriptCommand:
+    value = command.args.args[0]
+    return ScriptCommand(command.pos, cmd or command.name,
+                         ScriptFuncArgs(ScriptValue(value.pos, ScriptIdent(name))))
+
+class ScriptOptimizer:
+    by_name: dict[str, ScriptFunc]
+    started: set[str]
+
+    # started holds every script that can have a running instance: the startup
+    # script, trigger scripts and targets of start
+    def __init__(self, scripts: list[ScriptFunc], started: set[int]):
+        self.scripts = scripts
+        self.by_name = {script.name: script for script in scripts if script.name}
+        self.started = set(scripts[i].name for i in started if i < len(scripts))
+        for script in scripts:
+            for command in script.commands:
+                if command.name == 'start' and script_arg(command):
+                    self.started.add(script_arg(command))
+
+    # follow scripts that do nothing but jump elsewhere
+    def thread(self, name: str) -> str:
+        seen = set()
+        while name not in seen:
+            seen.add(name)
+            target = self.by_name.get(name)
+            if target is None or target.singleton or len(target.commands) != 1 \
+                    or target.commands[0].name != 'jump' or script_arg(target.commands[0]) is None:
+                break
+            name = script_arg(target.commands[0])
+        return name
+
+    def inlinable(self, caller: ScriptFunc, name: str) -> ScriptFunc | None:
+        callee = self.by_name.get(name)
+        if callee is None or callee is caller or callee.singleton:
+            return None
+        body = callee.commands
+        if len(body) == 0 or len(body) > INLINE_MAX_COMMANDS or body[-1].name != 'return':
+            return None
+        if any(command.name in ['jump', 'return'] for command in body[:-1]):
+            return None
+        return callee
+
+    def optimize_script(self, script: ScriptFunc) -> bool:
+        out: list[ScriptCommand] = []
+        for command in script.commands:
+            name = command.name
+            if name == 'noop':
+                continue
+            if name == 'delay' and int_arg(command) is not None:
+                frames = int_arg(command)
+                if frames == 0:
+                    continue
+                if len(out) > 0 and out[-1].name == 'delay' and int_arg(out[-1]) is not None \
+                        and int_arg(out[-1]) + frames <= 0xffffffff:
+                    frames += int_arg(out[-1])
+                    out[-1] = ScriptCommand(out[-1].pos, 'delay',
+                                            ScriptFuncArgs(ScriptValue(out[-1].args.args[0].pos, frames)))
+                    continue
+            # unknown names are kept so the compiler still reports them
+            if name in INSTANCE_COMMANDS and script_arg(command) in self.by_name \
+                    and script_arg(command) not in self.started:
+                continue
+            if name in ['jump', 'call'] and script_arg(command) is not None:
+                target = self.thread(script_arg(command))
+                if target != script_arg(command):
+                    command = with_script_arg(command, target)
+            if name == 'call' and script_arg(command) is not None:
+                callee = self.inlinable(script, script_arg(command))
+                if callee is not None:
+                    out += callee.commands[:-1]
+                    continue
+            if name == 'return' and len(out) > 0 and out[-1].name == 'call' \
+                    and script_arg(out[-1]) is not None:
+                out[-1] = with_script_arg(out[-1], script_arg(out[-1]), 'jump')
+                break
+            out.append(command)
+            if name in TERMINATORS:
+                break
+
+        changed = len(out) != len(script.commands) \
+                  or any(a is not b for a, b in zip(out, script.commands))
+        script.commands = out
+        return changed
+
+    def optimize(self):
+        # the implicit return is made explicit so every pass sees it
+        for script in self.scripts:
+            if len(script.commands) == 0 or script.commands[-1].name not in TERMINATORS:
+                script.commands.append(ScriptCommand((-1, -1), 'return'))
+        for _ in range(MAX_PASSES):
+            changed = False
+            for script in self.scripts:
+                changed |= self.optimize_script(script)
+            if not changed:
+                break
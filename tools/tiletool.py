@@ -2,15 +2,17 @@
 
 import argparse, itertools, math, pytiled_parser, util
 from pathlib import Path
-from struct import pack
-from util import err
+from util import err, pack
 
 parser = argparse.ArgumentParser(prog='Tile Definition Builder Tool')
 parser.add_argument('filename', type=Path)
 parser.add_argument('-o', '--output', type=Path, default=Path('.'))
 parser.add_argument('-v', '--verbose', action='store_true')
+parser.add_argument('-L', '--little-endian', action='store_true', help='write little endian data for the host build')
 
 args = parser.parse_args()
+if args.little_endian:
+    util.BYTE_ORDER = '<'
 
 def process_tiles(path):
     tiles = pytiled_parser.parse_tileset(path)
@@ -1,14 +1,21 @@
-import io, itertools, math, numpy, os, pycparser, pytiled_parser, re
+import io, itertools, math, numpy, os, pycparser, pytiled_parser, re, struct
 from pathlib import Path
-from struct import pack
 from typing import Optional
 
 C_ARRAY_RE = re.compile(r'(\w+)_paths')
 C_PATH_STEM_RE = re.compile(r'"rom:/([^"]+)\.\w+"')
 
+# '>' for the console, the host build sets '<' with -L
+BYTE_ORDER = '>'
+
 def err(msg: str):
     raise RuntimeError(msg)
 
+def pack(fmt: str, *values) -> bytes:
+    if fmt.startswith('>'):
+        fmt = BYTE_ORDER + fmt[1:]
+    return struct.pack(fmt, *values)
+
 def rotate_point(x0: int, y0: int, rot: int, xc: int, yc: int) -> (int, int):
     x0 -= xc
     y0 -= yc
@@ -93,6 +100,9 @@ class DataPool:
     data: io.BytesIO
     objs: list[PoolObj]
     def __init__(self, init: bytes | None = None):
+        # the magic is read back as a u32
+        if init and BYTE_ORDER == '<':
+            init = init[::-1]
         self.objs = []
         self.data = io.BytesIO(init)
         self.data.seek(0, io.SEEK_END)